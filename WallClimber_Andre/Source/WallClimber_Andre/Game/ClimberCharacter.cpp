@@ -85,7 +85,7 @@ void AClimberCharacter::UpdateMovement()
 	}
 
 	// Check if there are any nodes left in the path
-	if (CurrentNodeIndex >= CurrentTrackNodes.Num())
+	if (CurrentNodeIndex >= CurrentTrackPath.Num())
 	{
 		// If there are no more nodes to move to, stop the movement
 		bIsMovingAlongPath = false;
@@ -94,8 +94,7 @@ void AClimberCharacter::UpdateMovement()
 	}
 
 	// Proceed with movement towards the next node
-	FPathfindingNode NextNode = CurrentTrackNodes[CurrentNodeIndex];
-	FVector TargetLocation = NextNode.Location + CharacterPositionOffset; // Apply the offset to the node's location
+	FVector TargetLocation = CurrentTrackPath.GetLocation(CurrentNodeIndex) + CharacterPositionOffset; // Apply the offset to the node's location
 	FVector Direction = (TargetLocation - GetActorLocation()).GetSafeNormal();
 	float Distance = FVector::Dist(GetActorLocation(), TargetLocation);
 	float StepSize = CharacterSpeed * GetWorld()->GetDeltaSeconds();
@@ -112,7 +111,7 @@ void AClimberCharacter::UpdateMovement()
 		CurrentNodeIndex++; // Move to the next node
 
 		// Check if we have reached the end of the path
-		if (CurrentNodeIndex >= CurrentTrackNodes.Num())
+		if (CurrentNodeIndex >= CurrentTrackPath.Num())
 		{
 			bIsMovingAlongPath = false; // Stop moving if we've reached the last node
 			UE_LOG(LogTemp, Warning, TEXT("Reached the final node. Stopping movement."));
@@ -170,14 +169,14 @@ void AClimberCharacter::ResetMovementState()
 	// Ensure the character stops moving
 	bIsMovingAlongPath = false;
 
-	// Clear the current path nodes
-	CurrentTrackNodes.Empty();
+	// Clear the current path, handing its buffer back to the pool
+	CurrentTrackPath.Reset();
 
 	// Reset the current node index
 	CurrentNodeIndex = 0;
 }
 
-void AClimberCharacter::Move(TArray<FPathfindingNode> TrackNodes)
+void AClimberCharacter::Move(FPathfindingPath&& TrackPath)
 {
 	// If the character is already moving, do not allow a new movement to start
 	if (bIsMovingAlongPath)
@@ -187,13 +186,13 @@ void AClimberCharacter::Move(TArray<FPathfindingNode> TrackNodes)
 	}
 
 	// Log the move call
-	UE_LOG(LogTemp, Warning, TEXT("Move function called with %d nodes."), TrackNodes.Num());
+	UE_LOG(LogTemp, Warning, TEXT("Move function called with %d nodes."), TrackPath.Num());
 
-	// Set the new track nodes
-	CurrentTrackNodes = TrackNodes;
+	// Take over the new track
+	CurrentTrackPath = MoveTemp(TrackPath);
 
 	// Check if there are nodes to move to
-	if (CurrentTrackNodes.Num() > 0)
+	if (CurrentTrackPath.Num() > 0)
 	{
 		// Reset the current node index and start moving along the path
 		CurrentNodeIndex = 0;
@@ -90,8 +90,8 @@ public:
 	// Method to Zoom (Control springarm lenght)
 	void HandleZoomInput(float AxisValue);
 
-	// Method to follow path provided by the pathfinding component
-	void Move(TArray<FPathfindingNode> TrackNodes);
+	// Method to follow path provided by the pathfinding component. The path is moved in, not copied
+	void Move(FPathfindingPath&& TrackPath);
 
 protected:
 	// Called when the game starts or when spawned
@@ -115,7 +115,7 @@ private:
 	bool bIsCameraRotating;
 
 	// Track Movement
-	TArray<FPathfindingNode> CurrentTrackNodes;
+	FPathfindingPath CurrentTrackPath;
 	int32 CurrentNodeIndex;
 	FTimerHandle MovementTimerHandle;
 	bool bIsMovingAlongPath;
@@ -1,5 +1,15 @@
 #include "NavigationBuilder.h"
-#include "Algo/Find.h"
+#include "NavigationGridData.h"
+#include "NavigationGridCache.h"
+#include "Async/ParallelFor.h"
+#include "EngineUtils.h"
+#include "Hash/xxhash.h"
+#include "UObject/SoftObjectPath.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "TimerManager.h"
+
+// Moves between nodes: the grid is walked 8-connected, the same way the pathfinding graph searches it
+static const FIntPoint NodeStepOffsets[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1), FIntPoint(1, 1), FIntPoint(1, -1), FIntPoint(-1, 1), FIntPoint(-1, -1) };
 
 // Sets default values
 ANavigationBuilder::ANavigationBuilder()
@@ -22,7 +32,10 @@ void ANavigationBuilder::BeginPlay()
 {
 	Super::BeginPlay();
 
-	BuildNavigation();
+	if (!BakedNavigation || !LoadNavigationPayload(BakedNavigation->GetPayload()))
+	{
+		BuildNavigation();
+	}
 
 	if (!bNavigationActive)
 	{
@@ -37,15 +50,369 @@ void ANavigationBuilder::BeginPlay()
 }
 
 // Editor-callable function to build the navigation nodes
+// With bUseNavigationCache, a grid already built from the same settings and geometry is loaded from the cache instead of traced
 void ANavigationBuilder::BuildNavigation()
 {
+	// Packaged games load their baked grid, the cache only pays off while iterating on a level in the editor
+	const bool bUseCache = WITH_EDITOR && bUseNavigationCache;
+	const uint64 CacheKey = bUseCache ? ComputeNavigationHash() : 0;
+	if (bUseCache)
+	{
+		FNavigationGridCache& Cache = FNavigationGridCache::Get();
+		FNavigationGridPayload CachedGrid;
+		const bool bHit = Cache.Load(CacheKey, CachedGrid);
+		UE_LOG(LogTemp, Verbose, TEXT("Navigation cache %s for %s (%d hits, %d misses)"), bHit ? TEXT("hit") : TEXT("miss"), *GetName(), Cache.GetHits(), Cache.GetMisses());
+
+		if (bHit && LoadNavigationPayload(CachedGrid))
+			return;
+	}
+
 	InitializeNavigationGrid();
 	ConstructNavigationNodes();
-	ApplyThresholdBuffer();
+	ApplyThresholdBuffer(FIntRect(0, 0, GridIndex.SizeX, GridIndex.SizeY));
+	LabelComponents();
+	FinishNavigationBuild();
+
+	if (bUseCache)
+	{
+		FNavigationGridPayload BuiltGrid;
+		BuiltGrid.Store(GridLayout, GridIndex, ThresholdBuffer, NavigationNodesArray, WalkableCells, ComponentLabels);
+		FNavigationGridCache::Get().Store(CacheKey, BuiltGrid);
+	}
+}
+
+// Hash of everything a build reads: the builder's settings and placement, and the blocking collision of every actor inside the bounds
+// Obstacles count as much as Walkable actors, since the traces hit both
+uint64 ANavigationBuilder::ComputeNavigationHash() const
+{
+	FXxHash64Builder Hash;
+	auto HashVector = [](FXxHash64Builder& Builder, const FVector& Vector) { Builder.Update(&Vector, sizeof(FVector)); };
+	auto HashTransform = [&HashVector](FXxHash64Builder& Builder, const FTransform& Transform)
+	{
+		const FQuat Rotation = Transform.GetRotation();
+		HashVector(Builder, Transform.GetTranslation());
+		Builder.Update(&Rotation, sizeof(FQuat));
+		HashVector(Builder, Transform.GetScale3D());
+	};
+
+	// A new payload layout never reads an entry written by an older one
+	const uint32 Version = FNavigationGridPayload::CurrentVersion;
+	Hash.Update(&Version, sizeof(Version));
+	HashTransform(Hash, GetActorTransform());
+	HashVector(Hash, NavMeshExtents);
+	Hash.Update(&NavMeshDensity, sizeof(NavMeshDensity));
+	Hash.Update(&SpacingUnits, sizeof(SpacingUnits));
+	Hash.Update(&ThresholdBuffer, sizeof(ThresholdBuffer));
+
+	// Actors are iterated in no fixed order, so their hashes are sorted before they are combined
+	const FBox NavBounds = FBox(-NavMeshExtents, NavMeshExtents).TransformBy(GetActorTransform());
+	TArray<uint64> ActorHashes;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (Actor == this || !Actor->GetActorEnableCollision())
+			continue;
+
+		const FBox ActorBounds = Actor->GetComponentsBoundingBox();
+		if (!ActorBounds.IsValid || !ActorBounds.Intersect(NavBounds))
+			continue;
+
+		// Play In Editor renames the level's actors with a UEDPIE_N_ prefix. Without it the same actor hashes the same in the editor and in PIE
+		FXxHash64Builder ActorHash;
+		const FString ActorPath = UWorld::RemovePIEPrefix(FSoftObjectPath(Actor).ToString());
+		const bool bWalkable = Actor->Tags.Contains(FName("Walkable"));
+		ActorHash.Update(*ActorPath, ActorPath.Len() * sizeof(TCHAR));
+		ActorHash.Update(&bWalkable, sizeof(bWalkable));
+
+		Actor->ForEachComponent<UPrimitiveComponent>(false, [&ActorHash, &HashVector, &HashTransform](UPrimitiveComponent* Primitive)
+		{
+			// Only blocking collision stops the traces
+			if (!Primitive->IsCollisionEnabled() || Primitive->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+				return;
+
+			HashTransform(ActorHash, Primitive->GetComponentTransform());
+			HashVector(ActorHash, Primitive->Bounds.Origin);
+			HashVector(ActorHash, Primitive->Bounds.BoxExtent);
+
+			// The body setup gets a new GUID whenever its collision geometry is rebuilt
+			if (const UBodySetup* BodySetup = Primitive->GetBodySetup())
+				ActorHash.Update(&BodySetup->BodySetupGuid, sizeof(FGuid));
+		});
+
+		ActorHashes.Add(ActorHash.Finalize().Hash);
+	}
+
+	ActorHashes.Sort();
+	Hash.Update(ActorHashes.GetData(), ActorHashes.Num() * sizeof(uint64));
+	return Hash.Finalize().Hash;
+}
+
+// Editor-callable function to build the navigation nodes and bake them into BakedNavigation, so the level loads them instead of tracing
+void ANavigationBuilder::BakeNavigation()
+{
+	if (!BakedNavigation)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No BakedNavigation asset set on %s. Create a NavigationGridData asset and assign it before baking."), *GetName());
+		return;
+	}
+
+	BuildNavigation();
+	BakedNavigation->Store(GridLayout, GridIndex, ThresholdBuffer, NavigationNodesArray, WalkableCells, ComponentLabels);
+}
+
+// Hits and misses of the local navigation cache since the editor started
+void ANavigationBuilder::GetNavigationCacheStats(int32& OutHits, int32& OutMisses) const
+{
+	const FNavigationGridCache& Cache = FNavigationGridCache::Get();
+	OutHits = Cache.GetHits();
+	OutMisses = Cache.GetMisses();
+}
+
+// Load the nodes of a baked or cached grid. False when the payload is empty, or was built with other settings or at another place
+// The payload is already in memory as one block, so this is a single pass over the grid cells with no trace
+bool ANavigationBuilder::LoadNavigationPayload(const FNavigationGridPayload& Payload)
+{
+	const FNavigationGridBakeHeader* Header = Payload.GetHeader();
+	if (!Header)
+		return false;
+
+	const FNavigationGridLayout Layout = Payload.GetLayout();
+	if (Layout.Spacing != SpacingUnits / NavMeshDensity || !Layout.Extents.Equals(NavMeshExtents) || Header->ThresholdBuffer != ThresholdBuffer
+		|| !Layout.Transform.Equals(GetActorTransform()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Navigation data of %s does not match its settings or placement, tracing instead. Bake it again."), *GetName());
+		return false;
+	}
+
+	const uint64* NodeBits = Payload.GetNodeBits();
+	const uint64* WalkableBits = Payload.GetWalkableBits();
+	const uint64* ValidBits = Payload.GetValidBits();
+	const float* Heights = Payload.GetHeights();
+
+	// Every node bit takes the next height and label, so the bits must account for exactly NumNodes of them
+	const int32 NumCells = Header->SizeX * Header->SizeY;
+	int64 NumNodeBits = 0;
+	for (int32 Word = 0; Word < NumCells >> 6; ++Word)
+		NumNodeBits += FMath::CountBits(NodeBits[Word]);
+	if (NumCells & 63)
+		NumNodeBits += FMath::CountBits(NodeBits[NumCells >> 6] & ((1ULL << (NumCells & 63)) - 1));
+
+	if (NumNodeBits != Header->NumNodes)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Navigation data of %s is corrupt, tracing instead. Bake it again."), *GetName());
+		return false;
+	}
+
+	// The base grid is only needed to trace everything, and the payload replaces that
+	NavigationGrid.Empty();
+	IDArray.Empty();
+	RetiredSlots.Empty();
+	GridLayout = Layout;
+	GridIndex.Initialize(Header->SizeX, Header->SizeY);
+	WalkableCells.SetNumUninitialized(GridIndex.NodeIndices.Num());
+	NavigationNodesArray.SetNumUninitialized(Header->NumNodes);
+
+	int32 NodeIndex = 0;
+	for (int32 X = 0; X < GridIndex.SizeX; ++X)
+	{
+		for (int32 Y = 0; Y < GridIndex.SizeY; ++Y)
+		{
+			const int32 Cell = X * GridIndex.SizeY + Y;
+			WalkableCells[Cell] = FNavigationGridPayload::IsBitSet(WalkableBits, Cell);
+			if (!FNavigationGridPayload::IsBitSet(NodeBits, Cell))
+				continue;
+
+			FNavigationNode& Node = NavigationNodesArray[NodeIndex];
+			Node.ID = FIntPoint(X, Y);
+			const FVector GridPoint = GridLayout.GridIDToLocal(Node.ID);
+			Node.Location = GridLayout.Transform.TransformPosition(FVector(GridPoint.X, GridPoint.Y, Heights[NodeIndex]));
+			Node.bIsValid = FNavigationGridPayload::IsBitSet(ValidBits, Cell);
+			GridIndex.Add(Node.ID, NodeIndex++);
+		}
+	}
+
+	if (const int32* BakedLabels = Payload.GetComponentLabels())
+	{
+		// Baked labels are the components themselves, so every label is its own root
+		ComponentLabels.NodeLabels.Init(INDEX_NONE, Header->NumNodes);
+		int32 NumLabels = 0;
+		for (int32 LabelIndex = 0; LabelIndex < Header->NumNodes; ++LabelIndex)
+		{
+			ComponentLabels.NodeLabels.GetMutable(LabelIndex) = BakedLabels[LabelIndex];
+			NumLabels = FMath::Max(NumLabels, BakedLabels[LabelIndex] + 1);
+		}
+
+		ComponentLabels.LabelRoots.SetNum(NumLabels);
+		for (int32 Label = 0; Label < NumLabels; ++Label)
+		{
+			ComponentLabels.LabelRoots[Label] = Label;
+		}
+		CompactedLabelCount = NumLabels;
+	}
+	else
+	{
+		LabelComponents();
+	}
+
+	FinishNavigationBuild();
+	return true;
+}
+
+// Steps shared by every full build: debug drawing, state, and telling listeners every node changed
+void ANavigationBuilder::FinishNavigationBuild()
+{
 	CreateDebugGrid();
 
 	// Visualize in editor to check if the Navigation Grid is Active
 	bNavigationActive = NavigationNodesArray.Num() > 0;
+
+	// The full rebuild already covers every region marked dirty before it
+	DirtyRegions.Reset();
+
+	++NavigationVersion;
+	OnNavigationUpdated.Broadcast(TArray<FIntPoint>());
+}
+
+// Mark a world-space box whose geometry changed, so its cells are re-traced on the next tick
+void ANavigationBuilder::MarkDirtyRegion(const FBox& WorldBox)
+{
+	if (!WorldBox.IsValid || GridIndex.NodeIndices.Num() == 0)
+		return;
+
+	// Grid points whose trace starts inside the box footprint. Grid points only exist from ID 1 on, see InitializeNavigationGrid
+	const FBox LocalBox = WorldBox.InverseTransformBy(GridLayout.Transform);
+	const FIntRect Region(
+		FMath::Max(FMath::CeilToInt((LocalBox.Min.X + GridLayout.Extents.X) / GridLayout.Spacing), 1),
+		FMath::Max(FMath::CeilToInt((LocalBox.Min.Y + GridLayout.Extents.Y) / GridLayout.Spacing), 1),
+		FMath::Min(FMath::FloorToInt((LocalBox.Max.X + GridLayout.Extents.X) / GridLayout.Spacing) + 1, GridIndex.SizeX),
+		FMath::Min(FMath::FloorToInt((LocalBox.Max.Y + GridLayout.Extents.Y) / GridLayout.Spacing) + 1, GridIndex.SizeY));
+
+	if (Region.Min.X >= Region.Max.X || Region.Min.Y >= Region.Max.Y)
+		return;
+
+	// Boxes marked within the same frame are rebuilt together
+	if (DirtyRegions.Num() == 0)
+		GetWorldTimerManager().SetTimerForNextTick(this, &ANavigationBuilder::RebuildDirtyRegions);
+	DirtyRegions.Add(Region);
+}
+
+// Re-trace the cells of the dirty regions and re-apply the threshold buffer around them
+// Listeners get the cells whose node changed validity or location, appeared or vanished. Node slots stay where they are, see GetNavigationNodes
+void ANavigationBuilder::RebuildDirtyRegions()
+{
+	TArray<FIntRect> Regions = MoveTemp(DirtyRegions);
+	DirtyRegions.Reset();
+	if (Regions.Num() == 0 || GridIndex.NodeIndices.Num() == 0)
+		return;
+
+	// Cells under overlapping regions are traced once. Only the dirty cells are tracked, so the cost follows the regions, not the grid
+	TSet<int32> DirtyCells;
+	TArray<FIntPoint> DirtyIDs;
+	TArray<FVector> DirtyPoints;
+	for (const FIntRect& Region : Regions)
+	{
+		for (int32 X = Region.Min.X; X < Region.Max.X; ++X)
+		{
+			for (int32 Y = Region.Min.Y; Y < Region.Max.Y; ++Y)
+			{
+				bool bAlreadyDirty = false;
+				DirtyCells.Add(X * GridIndex.SizeY + Y, &bAlreadyDirty);
+				if (!bAlreadyDirty)
+				{
+					DirtyIDs.Add(FIntPoint(X, Y));
+					DirtyPoints.Add(GridLayout.GridIDToLocal(FIntPoint(X, Y)));
+				}
+			}
+		}
+	}
+
+	TArray<FGridTrace> Traces;
+	TraceGridPoints(DirtyPoints, Traces);
+
+	TSet<FIntPoint> ChangedIDs;
+	for (int32 Slot = 0; Slot < DirtyIDs.Num(); ++Slot)
+	{
+		const FIntPoint& ID = DirtyIDs[Slot];
+		const FGridTrace& Trace = Traces[Slot];
+		const int32 Cell = ID.X * GridIndex.SizeY + ID.Y;
+		WalkableCells[Cell] = Trace.HitActor && Trace.HitActor->Tags.Contains(FName("Walkable"));
+
+		int32 NodeIndex = GridIndex.NodeIndices[Cell];
+		if (Trace.HitActor && NodeIndex == INDEX_NONE)
+		{
+			// The cell gains a node: back into the slot it had before, or into a new one at the end
+			if (!RetiredSlots.RemoveAndCopyValue(Cell, NodeIndex))
+			{
+				NodeIndex = NavigationNodesArray.AddDefaulted();
+				ComponentLabels.NodeLabels.Add(INDEX_NONE);
+			}
+
+			FNavigationNode& Node = NavigationNodesArray[NodeIndex];
+			Node.ID = ID;
+			Node.Location = Trace.Location;
+			Node.bIsValid = WalkableCells[Cell]; // The threshold buffer is re-applied around the dirty regions
+			GridIndex.Add(ID, NodeIndex);
+			ChangedIDs.Add(ID);
+		}
+		else if (!Trace.HitActor && NodeIndex != INDEX_NONE)
+		{
+			// The cell loses its node. The slot stays, invalid and unreachable through the grid index, until the node returns
+			NavigationNodesArray[NodeIndex].bIsValid = false;
+			ComponentLabels.NodeLabels.GetMutable(NodeIndex) = INDEX_NONE;
+			GridIndex.Add(ID, INDEX_NONE);
+			RetiredSlots.Add(Cell, NodeIndex);
+			ChangedIDs.Add(ID);
+		}
+		else if (NodeIndex != INDEX_NONE && !NavigationNodesArray[NodeIndex].Location.Equals(Trace.Location))
+		{
+			NavigationNodesArray[NodeIndex].Location = Trace.Location;
+			ChangedIDs.Add(ID);
+		}
+	}
+
+	// Walkability changed inside the regions. That moves threshold nodes up to one cell out, and the buffer around them ThresholdBuffer cells further
+	const FIntRect Grid(0, 0, GridIndex.SizeX, GridIndex.SizeY);
+	for (FIntRect Region : Regions)
+	{
+		Region.InflateRect(FMath::Max(ThresholdBuffer, 0) + 1);
+		Region.Clip(Grid);
+		ApplyThresholdBuffer(Region, &ChangedIDs);
+	}
+
+	if (ChangedIDs.Num() == 0)
+		return;
+
+	++NavigationVersion;
+	bNavigationActive = NavigationNodesArray.Num() > RetiredSlots.Num();
+	const TArray<FIntPoint> ChangedIDArray = ChangedIDs.Array();
+
+	// Like every step above, the labels only change around the dirty window. Only a split walks further, through the pieces it cuts off
+	RelabelComponents(ChangedIDArray);
+	CreateDebugGrid();
+	OnNavigationUpdated.Broadcast(ChangedIDArray);
+}
+
+// Set the validity of existing nodes at runtime and notify listeners of the nodes that changed
+void ANavigationBuilder::SetNodesValidity(const TArray<FIntPoint>& NodeIDs, bool bValid)
+{
+	TArray<FIntPoint> ChangedIDs;
+	for (const FIntPoint& ID : NodeIDs)
+	{
+		int32 FoundNodeIndex = GridIndex.Find(ID);
+		if (FoundNodeIndex != INDEX_NONE && NavigationNodesArray[FoundNodeIndex].bIsValid != bValid)
+		{
+			NavigationNodesArray[FoundNodeIndex].bIsValid = bValid;
+			ChangedIDs.Add(ID);
+		}
+	}
+
+	if (ChangedIDs.Num() > 0)
+	{
+		++NavigationVersion;
+		RelabelComponents(ChangedIDs);
+		CreateDebugGrid();
+		OnNavigationUpdated.Broadcast(ChangedIDs);
+	}
 }
 
 // Build a base grid with provided extents, density and spacing
@@ -56,11 +423,16 @@ void ANavigationBuilder::InitializeNavigationGrid()
 	NavigationGrid.Empty();
 	IDArray.Empty();
 	NavigationNodesArray.Empty();
+	RetiredSlots.Empty();
 
 	// Create grid based on Box Extents and density
 	float Spacing = SpacingUnits / NavMeshDensity;
 	int32 TotalPointsX = FMath::FloorToInt(NavMeshExtents.X * 2 / Spacing);
 	int32 TotalPointsY = FMath::FloorToInt(NavMeshExtents.Y * 2 / Spacing);
+	GridIndex.Initialize(TotalPointsX, TotalPointsY);
+	WalkableCells.Init(false, GridIndex.NodeIndices.Num());
+	GridLayout.Spacing = Spacing;
+	GridLayout.Extents = NavMeshExtents;
 
 	// Generate base grid
 	for (int32 i = 1; i < TotalPointsX; i++)
@@ -77,61 +449,473 @@ void ANavigationBuilder::InitializeNavigationGrid()
 }
 
 // Use the default grid to create the navigation nodes array
+// Nodes are added in grid order, so the array follows the row-major order of the grid index
 void ANavigationBuilder::ConstructNavigationNodes()
 {
-	for (int32 i = 0; i < NavigationGrid.Num(); ++i)
-	{
-		const FVector& MeshPoint = NavigationGrid[i];
-		FVector StartPoint = GetActorTransform().TransformPosition(MeshPoint);
-		FVector EndPoint = GetActorTransform().TransformPosition(MeshPoint - FVector(0, 0, NavMeshExtents.Z * 2));
+	GridLayout.Transform = GetActorTransform();
 
-		FHitResult GridHitResult;
-		FCollisionQueryParams CollisionParams;
-		CollisionParams.AddIgnoredActor(this);
+	TArray<FGridTrace> Traces;
+	TraceGridPoints(NavigationGrid, Traces);
 
-		bool bHit = GetWorld()->LineTraceSingleByChannel(GridHitResult, StartPoint, EndPoint, ECC_Visibility, CollisionParams);
-
-		if (bHit)
+	NavigationNodesArray.Reserve(NavigationGrid.Num());
+	for (int32 i = 0; i < Traces.Num(); ++i)
+	{
+		if (Traces[i].HitActor)
 		{
 			FNavigationNode CurrentNode;
-			CurrentNode.Location = GridHitResult.Location;
-			CurrentNode.bIsValid = GridHitResult.GetActor()->Tags.Contains(FName("Walkable"));
+			CurrentNode.Location = Traces[i].Location;
+			CurrentNode.bIsValid = Traces[i].HitActor->Tags.Contains(FName("Walkable"));
 			CurrentNode.ID = IDArray[i];
-			NavigationNodesArray.Add(CurrentNode);
+			GridIndex.Add(CurrentNode.ID, NavigationNodesArray.Add(CurrentNode));
+			WalkableCells[CurrentNode.ID.X * GridIndex.SizeY + CurrentNode.ID.Y] = CurrentNode.bIsValid;
 		}
 	}
 	//UE_LOG(LogTemp, Warning, TEXT("Constructed %d navigation nodes."), NavigationNodesArray.Num());
 }
 
+// Trace grid points given in the builder's local space down through the grid, as placed by GridLayout
+// Traces run in parallel batches on the worker threads, each into its own slot. Hit actors are read back on the game thread
+void ANavigationBuilder::TraceGridPoints(const TArray<FVector>& LocalPoints, TArray<FGridTrace>& OutTraces) const
+{
+	// Everything the traces share is computed once
+	const FTransform& ActorTransform = GridLayout.Transform;
+	const FVector TraceDelta = ActorTransform.TransformVector(FVector(0, 0, -GridLayout.Extents.Z * 2));
+	const FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(NavigationBuilderTrace), false, this);
+	const UWorld* World = GetWorld();
+
+	OutTraces.Reset();
+	OutTraces.SetNum(LocalPoints.Num());
+
+	// Large enough that scheduling a batch costs far less than tracing it
+	constexpr int32 TracesPerBatch = 256;
+	const int32 NumBatches = FMath::DivideAndRoundUp(LocalPoints.Num(), TracesPerBatch);
+
+	ParallelFor(NumBatches, [&LocalPoints, &OutTraces, &ActorTransform, &TraceDelta, &CollisionParams, World](int32 BatchIndex)
+	{
+		const int32 First = BatchIndex * TracesPerBatch;
+		const int32 Last = FMath::Min(First + TracesPerBatch, LocalPoints.Num());
+		for (int32 i = First; i < Last; ++i)
+		{
+			const FVector StartPoint = ActorTransform.TransformPosition(LocalPoints[i]);
+
+			FHitResult GridHitResult;
+			if (World->LineTraceSingleByChannel(GridHitResult, StartPoint, StartPoint + TraceDelta, ECC_Visibility, CollisionParams))
+			{
+				OutTraces[i].Location = GridHitResult.Location;
+				OutTraces[i].HitActor = GridHitResult.GetActor();
+			}
+		}
+	});
+}
+
 // Expand the threshold of invalid nodes (obstacles). The main purpose is to avoid navigation too close to obstacles, preventing clipping
-void ANavigationBuilder::ApplyThresholdBuffer()
+// Nodes inside Region are set from their walkability, and walkable nodes within ThresholdBuffer cells of a threshold node are invalidated.
+// The distance transform finds each cell's distance to its nearest threshold node in a fixed number of passes, so the buffer radius does not change the cost
+void ANavigationBuilder::ApplyThresholdBuffer(const FIntRect& Region, TSet<FIntPoint>* OutChangedIDs)
+{
+	// Threshold nodes up to ThresholdBuffer cells outside the region still buffer the cells inside it
+	FIntRect Window = Region;
+	TArray<int64> SquaredDistances;
+	if (ThresholdBuffer > 0)
+	{
+		Window.InflateRect(ThresholdBuffer);
+		Window.Clip(FIntRect(0, 0, GridIndex.SizeX, GridIndex.SizeY));
+		ComputeThresholdDistances(Window, SquaredDistances);
+	}
+
+	const int64 SquaredBuffer = static_cast<int64>(ThresholdBuffer) * ThresholdBuffer;
+	const int32 WindowSizeY = Window.Max.Y - Window.Min.Y;
+	for (int32 X = Region.Min.X; X < Region.Max.X; ++X)
+	{
+		for (int32 Y = Region.Min.Y; Y < Region.Max.Y; ++Y)
+		{
+			const int32 NodeIndex = GridIndex.Find(FIntPoint(X, Y));
+			if (NodeIndex == INDEX_NONE)
+				continue;
+
+			bool bIsValid = WalkableCells[X * GridIndex.SizeY + Y];
+			if (bIsValid && ThresholdBuffer > 0)
+				bIsValid = SquaredDistances[(X - Window.Min.X) * WindowSizeY + (Y - Window.Min.Y)] > SquaredBuffer;
+
+			FNavigationNode& Node = NavigationNodesArray[NodeIndex];
+			if (Node.bIsValid != bIsValid)
+			{
+				Node.bIsValid = bIsValid;
+				if (OutChangedIDs)
+					OutChangedIDs->Add(Node.ID);
+			}
+		}
+	}
+}
+
+// Squared Euclidean distance from every cell of Window to the nearest threshold node inside it, MAX_int64 where there is none
+// Row-major over the window. Exact two-pass transform: distances along each row first, then the lower envelope of parabolas down each column
+void ANavigationBuilder::ComputeThresholdDistances(const FIntRect& Window, TArray<int64>& OutSquaredDistances) const
+{
+	const int32 SizeX = Window.Max.X - Window.Min.X;
+	const int32 SizeY = Window.Max.Y - Window.Min.Y;
+	OutSquaredDistances.SetNumUninitialized(SizeX * SizeY);
+
+	// Rows: distance to the nearest threshold node on the same row, swept from both ends
+	for (int32 X = 0; X < SizeX; ++X)
+	{
+		int64* Row = OutSquaredDistances.GetData() + X * SizeY;
+		int32 LastSeed = INDEX_NONE;
+		for (int32 Y = 0; Y < SizeY; ++Y)
+		{
+			if (IsThresholdNode(Window.Min + FIntPoint(X, Y)))
+				LastSeed = Y;
+			Row[Y] = LastSeed != INDEX_NONE ? Y - LastSeed : MAX_int32;
+		}
+		LastSeed = INDEX_NONE;
+		for (int32 Y = SizeY - 1; Y >= 0; --Y)
+		{
+			if (Row[Y] == 0)
+				LastSeed = Y;
+			const int64 Distance = LastSeed != INDEX_NONE ? FMath::Min<int64>(Row[Y], LastSeed - Y) : Row[Y];
+			Row[Y] = Distance != MAX_int32 ? Distance * Distance : MAX_int64;
+		}
+	}
+
+	// Columns: each row distance is a parabola over X, the lowest one at every cell gives the 2D distance
+	TArray<int64> Column;
+	TArray<int64> Envelope;
+	TArray<int32> Apexes;
+	TArray<double> Bounds;
+	Column.SetNumUninitialized(SizeX);
+	Envelope.SetNumUninitialized(SizeX);
+	Apexes.SetNumUninitialized(SizeX);
+	Bounds.SetNumUninitialized(SizeX + 1);
+
+	for (int32 Y = 0; Y < SizeY; ++Y)
+	{
+		for (int32 X = 0; X < SizeX; ++X)
+			Column[X] = OutSquaredDistances[X * SizeY + Y];
+
+		LowerEnvelope(Column.GetData(), SizeX, Envelope.GetData(), Apexes.GetData(), Bounds.GetData());
+
+		for (int32 X = 0; X < SizeX; ++X)
+			OutSquaredDistances[X * SizeY + Y] = Envelope[X];
+	}
+}
+
+// Lower envelope of the parabolas (X - Q)^2 + Heights[Q], sampled at every X. Heights of MAX_int64 have no parabola
+// Apexes and Bounds are scratch space of Num and Num + 1 entries
+void ANavigationBuilder::LowerEnvelope(const int64* Heights, int32 Num, int64* OutEnvelope, int32* Apexes, double* Bounds)
+{
+	int32 Top = INDEX_NONE;
+	for (int32 Q = 0; Q < Num; ++Q)
+	{
+		if (Heights[Q] == MAX_int64)
+			continue;
+
+		// Drop the parabolas the new one lies below over their whole interval
+		double Intersection = -DBL_MAX;
+		while (Top != INDEX_NONE)
+		{
+			const int32 P = Apexes[Top];
+			Intersection = static_cast<double>((Heights[Q] + static_cast<int64>(Q) * Q) - (Heights[P] + static_cast<int64>(P) * P)) / (2.0 * (Q - P));
+			if (Intersection > Bounds[Top])
+				break;
+			--Top;
+		}
+
+		if (Top == INDEX_NONE)
+			Intersection = -DBL_MAX;
+		++Top;
+		Apexes[Top] = Q;
+		Bounds[Top] = Intersection;
+		Bounds[Top + 1] = DBL_MAX;
+	}
+
+	if (Top == INDEX_NONE)
+	{
+		for (int32 X = 0; X < Num; ++X)
+			OutEnvelope[X] = MAX_int64;
+		return;
+	}
+
+	int32 Segment = 0;
+	for (int32 X = 0; X < Num; ++X)
+	{
+		while (Bounds[Segment + 1] < X)
+			++Segment;
+		const int64 Offset = X - Apexes[Segment];
+		OutEnvelope[X] = Offset * Offset + Heights[Apexes[Segment]];
+	}
+}
+
+// A node that is not walkable with a walkable node right next to it, where the buffer around an obstacle starts
+bool ANavigationBuilder::IsThresholdNode(const FIntPoint& ID) const
+{
+	if (GridIndex.Find(ID) == INDEX_NONE || WalkableCells[ID.X * GridIndex.SizeY + ID.Y])
+		return false;
+
+	for (int32 Step = 0; Step < 4; ++Step) // The cross moves, GetCircularNeighbors(1)
+	{
+		const FIntPoint NeighborID = ID + NodeStepOffsets[Step];
+		if (GridIndex.IsInside(NeighborID) && WalkableCells[NeighborID.X * GridIndex.SizeY + NeighborID.Y])
+			return true;
+	}
+	return false;
+}
+
+
+// Label the connected components of valid nodes, so a goal that cannot be reached is known without searching for it
+void ANavigationBuilder::LabelComponents()
 {
-	TArray<FNavigationNode> CulledGrid = NavigationNodesArray; // Nodes to modify
-	TArray<FNavigationNode> ThresholdNodes = FindThresholdNodes(NavigationNodesArray); // Initial threshold nodes
+	ComponentLabels.NodeLabels.Init(INDEX_NONE, NavigationNodesArray.Num());
+	ComponentLabels.LabelRoots.Reset();
+
+	for (int32 NodeIndex = 0; NodeIndex < NavigationNodesArray.Num(); ++NodeIndex)
+	{
+		if (NavigationNodesArray[NodeIndex].bIsValid && ComponentLabels.NodeLabels[NodeIndex] == INDEX_NONE)
+		{
+			FloodComponent(NodeIndex, ComponentLabels.LabelRoots.Add(ComponentLabels.LabelRoots.Num()));
+		}
+	}
 
-	TArray<FIntPoint> CircularNeighbors = GetCircularNeighbors(ThresholdBuffer); // Get neighbors within the circular range
+	CompactedLabelCount = ComponentLabels.LabelRoots.Num();
+}
 
-	for (const FNavigationNode& Node : ThresholdNodes)
+// Update the labels around an edit without flooding the components it touches
+// A node that became valid joins the components it steps into by a label remap. Around nodes that became invalid, the components are only
+// split if floods from their neighbors fail to meet, see SplitComponent
+void ANavigationBuilder::RelabelComponents(const TArray<FIntPoint>& ChangedIDs)
+{
+	TArray<FIntPoint> BlockedIDs;
+	for (const FIntPoint& ChangedID : ChangedIDs)
 	{
-		for (const FIntPoint& NeighborOffset : CircularNeighbors)
+		// A cell that lost its node had its label cleared with it
+		const int32 ChangedIndex = GridIndex.Find(ChangedID);
+		if (ChangedIndex == INDEX_NONE || !NavigationNodesArray[ChangedIndex].bIsValid)
 		{
-			FIntPoint TargetID = Node.ID + NeighborOffset;
-			FNavigationNode* FoundNode = Algo::FindBy(CulledGrid, TargetID, &FNavigationNode::ID);
+			if (ChangedIndex != INDEX_NONE && ComponentLabels.NodeLabels[ChangedIndex] != INDEX_NONE)
+			{
+				ComponentLabels.NodeLabels.GetMutable(ChangedIndex) = INDEX_NONE;
+			}
+			BlockedIDs.Add(ChangedID);
+		}
+		else if (ComponentLabels.NodeLabels[ChangedIndex] == INDEX_NONE)
+		{
+			// Neighbors that became valid in the same edit have no label yet. They join this node when their own turn comes
+			int32 Root = INDEX_NONE;
+			for (const FIntPoint& Offset : NodeStepOffsets)
+			{
+				const int32 NeighborIndex = FindValidNeighbor(ChangedID, Offset);
+				const int32 NeighborRoot = NeighborIndex != INDEX_NONE ? ComponentLabels.Find(NeighborIndex) : INDEX_NONE;
+				if (NeighborRoot == INDEX_NONE)
+					continue;
+
+				if (Root == INDEX_NONE)
+					Root = NeighborRoot;
+				else
+					MergeComponents(Root, NeighborRoot);
+			}
+			ComponentLabels.NodeLabels.GetMutable(ChangedIndex) = Root != INDEX_NONE ? Root : ComponentLabels.LabelRoots.Add(ComponentLabels.LabelRoots.Num());
+		}
+	}
 
-			if (FoundNode != nullptr && FoundNode->bIsValid)
+	// Every path a blocked cell cut ran through two of its neighbors, so only the components around it can have come apart
+	TMap<int32, TSet<int32>> SplitSeeds;
+	for (const FIntPoint& BlockedID : BlockedIDs)
+	{
+		for (const FIntPoint& Offset : NodeStepOffsets)
+		{
+			const int32 NeighborIndex = GridIndex.Find(BlockedID + Offset);
+			if (NeighborIndex != INDEX_NONE && NavigationNodesArray[NeighborIndex].bIsValid)
 			{
-				int32 FoundNodeIndex = CulledGrid.IndexOfByKey(*FoundNode);
-				if (FoundNodeIndex != INDEX_NONE)
+				SplitSeeds.FindOrAdd(ComponentLabels.Find(NeighborIndex)).Add(NeighborIndex);
+			}
+		}
+	}
+	for (const TPair<int32, TSet<int32>>& Seeds : SplitSeeds)
+	{
+		if (Seeds.Value.Num() > 1)
+		{
+			SplitComponent(Seeds.Value.Array());
+		}
+	}
+
+	// Labels of blocked components and joined components pile up. Once they have doubled, one pass drops them
+	if (ComponentLabels.LabelRoots.Num() > FMath::Max(2 * CompactedLabelCount, 4096))
+	{
+		CompactComponentLabels();
+	}
+}
+
+// Give Label to every valid node connected to the seed that has no label yet
+void ANavigationBuilder::FloodComponent(int32 SeedIndex, int32 Label)
+{
+	TArray<int32> Stack;
+	ComponentLabels.NodeLabels.GetMutable(SeedIndex) = Label;
+	Stack.Add(SeedIndex);
+
+	while (Stack.Num() > 0)
+	{
+		const FIntPoint CurrentID = NavigationNodesArray[Stack.Pop(false)].ID;
+		for (const FIntPoint& Offset : NodeStepOffsets)
+		{
+			const int32 NeighborIndex = FindValidNeighbor(CurrentID, Offset);
+			if (NeighborIndex != INDEX_NONE && ComponentLabels.NodeLabels[NeighborIndex] == INDEX_NONE)
+			{
+				ComponentLabels.NodeLabels.GetMutable(NeighborIndex) = Label;
+				Stack.Add(NeighborIndex);
+			}
+		}
+	}
+}
+
+// Join two components by pointing every label of MergedRoot at KeptRoot. No node label is written
+void ANavigationBuilder::MergeComponents(int32 KeptRoot, int32 MergedRoot)
+{
+	if (KeptRoot == MergedRoot)
+		return;
+
+	for (int32& Root : ComponentLabels.LabelRoots)
+	{
+		if (Root == MergedRoot)
+		{
+			Root = KeptRoot;
+		}
+	}
+}
+
+// Split the component of the seeds into the pieces an edit cut it into
+// A flood runs from every seed, all of them one node at a time, and floods that meet are joined. A flood that runs out of nodes while others
+// are still going is a piece of its own and takes a fresh label. The floods stop once one is left, which keeps the component's label, so the
+// work follows the pieces cut off, and a cut that leaves the seeds connected only costs the few steps around it
+void ANavigationBuilder::SplitComponent(const TArray<int32>& SeedIndices)
+{
+	// Nodes every flood reached in order, expanded up to Heads. A flood that met a larger one carries on as part of it, see JoinedInto
+	TArray<TArray<int32>> Reached;
+	TArray<int32> Heads;
+	TArray<int32> JoinedInto;
+	TArray<int32> ActiveFloods;
+	TMap<int32, int32> NodeFloods;
+	for (const int32 SeedIndex : SeedIndices)
+	{
+		const int32 Flood = Reached.Num();
+		Reached.Add({ SeedIndex });
+		Heads.Add(0);
+		JoinedInto.Add(Flood);
+		ActiveFloods.Add(Flood);
+		NodeFloods.Add(SeedIndex, Flood);
+	}
+
+	auto FindFlood = [&JoinedInto](int32 Flood)
+	{
+		while (JoinedInto[Flood] != Flood)
+			Flood = JoinedInto[Flood];
+		return Flood;
+	};
+
+	int32 NumActive = ActiveFloods.Num();
+	while (NumActive > 1)
+	{
+		for (const int32 ActiveFlood : ActiveFloods)
+		{
+			int32 Flood = ActiveFlood;
+			if (NumActive == 1 || JoinedInto[Flood] != Flood || Heads[Flood] < 0)
+				continue;
+
+			if (Heads[Flood] == Reached[Flood].Num())
+			{
+				const int32 Label = ComponentLabels.LabelRoots.Add(ComponentLabels.LabelRoots.Num());
+				for (const int32 NodeIndex : Reached[Flood])
 				{
-					CulledGrid[FoundNodeIndex].bIsValid = false; // Invalidate the node
+					ComponentLabels.NodeLabels.GetMutable(NodeIndex) = Label;
 				}
+				Heads[Flood] = INDEX_NONE;
+				--NumActive;
+				continue;
+			}
+
+			const FIntPoint CurrentID = NavigationNodesArray[Reached[Flood][Heads[Flood]++]].ID;
+			for (const FIntPoint& Offset : NodeStepOffsets)
+			{
+				const int32 NeighborIndex = FindValidNeighbor(CurrentID, Offset);
+				if (NeighborIndex == INDEX_NONE)
+					continue;
+
+				const int32* NeighborFlood = NodeFloods.Find(NeighborIndex);
+				if (!NeighborFlood)
+				{
+					NodeFloods.Add(NeighborIndex, Flood);
+					Reached[Flood].Add(NeighborIndex);
+					continue;
+				}
+
+				const int32 OtherFlood = FindFlood(*NeighborFlood);
+				if (OtherFlood == Flood)
+					continue;
+
+				// The floods met. The larger one takes over the nodes of both, the expanded ones first
+				const int32 Kept = Reached[Flood].Num() >= Reached[OtherFlood].Num() ? Flood : OtherFlood;
+				const int32 Merged = Kept == Flood ? OtherFlood : Flood;
+				TArray<int32> Joined;
+				Joined.Reserve(Reached[Kept].Num() + Reached[Merged].Num());
+				Joined.Append(Reached[Kept].GetData(), Heads[Kept]);
+				Joined.Append(Reached[Merged].GetData(), Heads[Merged]);
+				Joined.Append(Reached[Kept].GetData() + Heads[Kept], Reached[Kept].Num() - Heads[Kept]);
+				Joined.Append(Reached[Merged].GetData() + Heads[Merged], Reached[Merged].Num() - Heads[Merged]);
+				Heads[Kept] += Heads[Merged];
+				Reached[Kept] = MoveTemp(Joined);
+				Reached[Merged].Empty();
+				JoinedInto[Merged] = Kept;
+				--NumActive;
+				Flood = Kept;
 			}
 		}
+
+		ActiveFloods.RemoveAll([&JoinedInto, &Heads](int32 Flood) { return JoinedInto[Flood] != Flood || Heads[Flood] < 0; });
 	}
+}
+
+// Number the components densely and point every node straight at its component, dropping the labels no node uses any more
+void ANavigationBuilder::CompactComponentLabels()
+{
+	TArray<int32> CompactLabels;
+	CompactLabels.Init(INDEX_NONE, ComponentLabels.LabelRoots.Num());
+	int32 NumLabels = 0;
+
+	for (int32 NodeIndex = 0; NodeIndex < ComponentLabels.Num(); ++NodeIndex)
+	{
+		const int32 Root = ComponentLabels.Find(NodeIndex);
+		if (Root == INDEX_NONE)
+			continue;
+
+		if (CompactLabels[Root] == INDEX_NONE)
+			CompactLabels[Root] = NumLabels++;
 
-	NavigationNodesArray = CulledGrid; // Update the main navigation nodes array
+		if (ComponentLabels.NodeLabels[NodeIndex] != CompactLabels[Root])
+			ComponentLabels.NodeLabels.GetMutable(NodeIndex) = CompactLabels[Root];
+	}
+
+	ComponentLabels.LabelRoots.SetNum(NumLabels);
+	for (int32 Label = 0; Label < NumLabels; ++Label)
+	{
+		ComponentLabels.LabelRoots[Label] = Label;
+	}
+	CompactedLabelCount = NumLabels;
 }
 
+// Index of the valid node one step away, INDEX_NONE if the step is blocked. Diagonal steps may not cut the corner of an invalid node
+int32 ANavigationBuilder::FindValidNeighbor(const FIntPoint& ID, const FIntPoint& Offset) const
+{
+	auto FindValidNode = [this](const FIntPoint& NodeID)
+	{
+		const int32 NodeIndex = GridIndex.Find(NodeID);
+		return (NodeIndex != INDEX_NONE && NavigationNodesArray[NodeIndex].bIsValid) ? NodeIndex : INDEX_NONE;
+	};
+
+	if (Offset.X != 0 && Offset.Y != 0
+		&& (FindValidNode(FIntPoint(ID.X + Offset.X, ID.Y)) == INDEX_NONE || FindValidNode(FIntPoint(ID.X, ID.Y + Offset.Y)) == INDEX_NONE))
+	{
+		return INDEX_NONE;
+	}
+	return FindValidNode(ID + Offset);
+}
 
 // Show debug grid with valid and not valid nodes
 void ANavigationBuilder::CreateDebugGrid()
@@ -139,8 +923,13 @@ void ANavigationBuilder::CreateDebugGrid()
 	if (bEnableDebugging)
 	{
 		FlushPersistentDebugLines(GetWorld());
-		for (const FNavigationNode& Node : NavigationNodesArray)
+		for (int32 NodeIndex = 0; NodeIndex < NavigationNodesArray.Num(); ++NodeIndex)
 		{
+			// Retired slots are no longer on the grid
+			const FNavigationNode& Node = NavigationNodesArray[NodeIndex];
+			if (GridIndex.Find(Node.ID) != NodeIndex)
+				continue;
+
 			FColor NodeColor = Node.bIsValid ? FColor::Green : FColor::Red;
 			DrawDebugPoint(GetWorld(), Node.Location, 10.f, NodeColor, true, -1.f);
 		}
@@ -174,32 +963,6 @@ TArray<FIntPoint> ANavigationBuilder::GetCircularNeighbors(int32 Radius)
 	return Neighbors;
 }
 
-// Helper function to find threshold nodes
-TArray<FNavigationNode> ANavigationBuilder::FindThresholdNodes(TArray<FNavigationNode> SourceNodes)
-{
-	TArray<FNavigationNode> ThresholdNodes;
-	TArray<FIntPoint> ImmediateNeighbors = GetCircularNeighbors(1);
-
-	for (const FNavigationNode& Node : SourceNodes)
-	{
-		if (!Node.bIsValid)
-		{
-			for (const FIntPoint& Neighbor : ImmediateNeighbors)
-			{
-				FIntPoint TargetID = Node.ID + Neighbor;
-				FNavigationNode* FoundNode = Algo::FindBy(SourceNodes, TargetID, &FNavigationNode::ID);
-
-				if (FoundNode != nullptr && FoundNode->bIsValid)
-				{
-					ThresholdNodes.Add(Node);
-					break;
-				}
-			}
-		}
-	}
-	return ThresholdNodes;
-}
-
 // Public method to return NavigationNodes grid - Core variables to build A* Algorithm
 TArray<FNavigationNode> ANavigationBuilder::GetNavigationNodesArray()
 {
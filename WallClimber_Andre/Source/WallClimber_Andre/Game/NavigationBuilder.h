@@ -3,8 +3,12 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/BoxComponent.h"
+#include "NavigationPagedArray.h"
 #include "NavigationBuilder.generated.h"
 
+class UNavigationGridData;
+struct FNavigationGridPayload;
+
 USTRUCT(BlueprintType)
 struct FNavigationNode
 {
@@ -26,6 +30,93 @@ struct FNavigationNode
 	}
 };
 
+// Dense row-major lookup from a grid ID to its index in the navigation nodes array
+// Rows are indexed by ID.X, so a cell lives at ID.X * SizeY + ID.Y. Grid points without a trace hit map to INDEX_NONE
+// Copies share the table's pages, so the pathfinding graph takes a copy of it without copying the grid
+struct FNavigationGridIndex
+{
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	TNavigationPagedArray<int32> NodeIndices;
+
+	// Allocate a SizeX by SizeY table where every cell is empty
+	void Initialize(int32 InSizeX, int32 InSizeY)
+	{
+		SizeX = FMath::Max(InSizeX, 0);
+		SizeY = FMath::Max(InSizeY, 0);
+		NodeIndices.Init(INDEX_NONE, SizeX * SizeY);
+	}
+
+	bool IsInside(const FIntPoint& ID) const
+	{
+		return ID.X >= 0 && ID.X < SizeX && ID.Y >= 0 && ID.Y < SizeY;
+	}
+
+	// Register the node stored at NodeIndex for the given grid ID
+	void Add(const FIntPoint& ID, int32 NodeIndex)
+	{
+		check(IsInside(ID));
+		NodeIndices.GetMutable(ID.X * SizeY + ID.Y) = NodeIndex;
+	}
+
+	// Node index for the grid ID, INDEX_NONE if it is outside the grid or was never hit
+	int32 Find(const FIntPoint& ID) const
+	{
+		return IsInside(ID) ? NodeIndices[ID.X * SizeY + ID.Y] : INDEX_NONE;
+	}
+};
+
+// Connected component of every navigation node, in node order
+// Edits that join components remap the label of one onto the other instead of relabelling its nodes, so the component of a node is the root of
+// its label. Copies share the label pages, and only the small root table is copied whole
+struct FNavigationComponentLabels
+{
+	// Label of every node, INDEX_NONE for invalid nodes
+	TNavigationPagedArray<int32> NodeLabels;
+
+	// Component every label belongs to. Roots map to themselves, every other label straight to its root
+	TArray<int32> LabelRoots;
+
+	int32 Num() const { return NodeLabels.Num(); }
+
+	// Component of the node, INDEX_NONE if it is invalid. Valid nodes share a component exactly when a path joins them
+	int32 Find(int32 NodeIndex) const
+	{
+		const int32 Label = NodeLabels[NodeIndex];
+		return Label == INDEX_NONE ? INDEX_NONE : LabelRoots[Label];
+	}
+};
+
+// Placement of the grid in the world, captured when the navigation is built
+// Grid ID (i, j) sits at (i * Spacing - Extents.X, j * Spacing - Extents.Y) in the builder's local space, traced along its local Z
+struct FNavigationGridLayout
+{
+	FTransform Transform = FTransform::Identity;
+	float Spacing = 1.f;
+	FVector Extents = FVector::ZeroVector;
+
+	// Grid ID of the grid point nearest to a location in the builder's local space, whether or not a node exists there
+	FIntPoint LocalToGridID(const FVector& LocalLocation) const
+	{
+		return FIntPoint(FMath::RoundToInt((LocalLocation.X + Extents.X) / Spacing), FMath::RoundToInt((LocalLocation.Y + Extents.Y) / Spacing));
+	}
+
+	// Point in the builder's local space where the trace of a grid ID starts
+	FVector GridIDToLocal(const FIntPoint& ID) const
+	{
+		return FVector(ID.X * Spacing - Extents.X, ID.Y * Spacing - Extents.Y, Extents.Z);
+	}
+
+	// Grid ID of the grid point nearest to a world location, whether or not a node exists there
+	FIntPoint WorldToGridID(const FVector& WorldLocation) const
+	{
+		return LocalToGridID(Transform.InverseTransformPosition(WorldLocation));
+	}
+};
+
+// Broadcast when navigation nodes change. ChangedIDs lists the cells whose node changed validity or location, appeared or vanished. It is empty after a full rebuild
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnNavigationUpdated, const TArray<FIntPoint>& /*ChangedIDs*/);
+
 UCLASS()
 class WALLCLIMBER_ANDRE_API ANavigationBuilder : public AActor
 {
@@ -53,6 +144,14 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Default")
 	float SpacingUnits = 1000.f;
 
+	// Grid baked in the editor with BakeNavigation. BeginPlay loads it instead of tracing, and only traces when it is missing or stale
+	UPROPERTY(EditAnywhere, Category = "Default")
+	UNavigationGridData* BakedNavigation = nullptr;
+
+	// Reuse grids built before from the same settings and geometry, kept in the local navigation cache. Editor builds only
+	UPROPERTY(EditAnywhere, Category = "Default")
+	bool bUseNavigationCache = true;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Default")
 	bool bNavigationActive = false; // Default to false, will be set true when navigation is built
 
@@ -66,21 +165,92 @@ public:
 	UFUNCTION(BlueprintCallable, CallInEditor)
 	void BuildNavigation();
 
+	// Build the navigation and store it into BakedNavigation. Save the asset afterwards
+	UFUNCTION(CallInEditor)
+	void BakeNavigation();
+
 	UFUNCTION(BlueprintCallable, CallInEditor)
 	void ClearDebugObjects();
 
+	// Hits and misses of the local navigation cache since the editor started
+	UFUNCTION(BlueprintCallable)
+	void GetNavigationCacheStats(int32& OutHits, int32& OutMisses) const;
+
+	// Set the validity of existing nodes at runtime (a hold breaks, a passage opens) and notify listeners of the nodes that changed
+	UFUNCTION(BlueprintCallable)
+	void SetNodesValidity(const TArray<FIntPoint>& NodeIDs, bool bValid);
+
+	// Mark a world-space box whose geometry changed (an obstacle moved, a platform appeared). Only the cells under it are re-traced, on the next tick
+	// A moved obstacle needs both the box it left and the box it moved into
+	UFUNCTION(BlueprintCallable)
+	void MarkDirtyRegion(const FBox& WorldBox);
+
+	// Rebuild the regions marked dirty right away instead of on the next tick. Validity set through SetNodesValidity near them is replaced by what the geometry gives
+	UFUNCTION(BlueprintCallable)
+	void RebuildDirtyRegions();
+
+	FOnNavigationUpdated OnNavigationUpdated;
+
+	// Incremented every time the nodes are rebuilt or edited, so anything derived from them can tell it is stale
+	uint32 GetNavigationVersion() const { return NavigationVersion; }
+
 	TArray<FNavigationNode> GetNavigationNodesArray();
+
+	// Nodes in grid order after a full build. A cell that loses its node in a dirty rebuild keeps the node's slot as an invalid node no grid ID
+	// maps to, and takes it back if the node returns. Nodes of new cells are appended, so node indices never shift until the next full build
+	const TArray<FNavigationNode>& GetNavigationNodes() const { return NavigationNodesArray; }
 	TArray<FIntPoint> GetCircularNeighbors(int32 Radius);
+	const FNavigationGridIndex& GetGridIndex() const { return GridIndex; }
+	const FNavigationGridLayout& GetGridLayout() const { return GridLayout; }
+
+	// Connected component of every navigation node, in node order. Valid nodes share a component exactly when a path joins them
+	const FNavigationComponentLabels& GetComponentLabels() const { return ComponentLabels; }
 
 private:
 	TArray<FVector> NavigationGrid;
 	TArray<FIntPoint> IDArray;
 	TArray<FNavigationNode> NavigationNodesArray;
+	FNavigationGridIndex GridIndex;
+	FNavigationGridLayout GridLayout;
+	uint32 NavigationVersion = 0;
+	FNavigationComponentLabels ComponentLabels;
 
+	// Number of labels after the last full labelling or compaction. The labels are compacted once edits have doubled it
+	int32 CompactedLabelCount = 0;
+
+	// Node slots of the cells that lost their node in a dirty rebuild, by row-major cell
+	TMap<int32, int32> RetiredSlots;
+
+	// Whether the trace of every grid cell hit a Walkable actor, before the threshold buffer. Row-major like the grid index
+	TArray<bool> WalkableCells;
+
+	// Grid ID ranges waiting to be re-traced, max exclusive
+	TArray<FIntRect> DirtyRegions;
+
+	// Result of tracing one grid point
+	struct FGridTrace
+	{
+		FVector Location;
+		const AActor* HitActor = nullptr;
+	};
+
+	bool LoadNavigationPayload(const FNavigationGridPayload& Payload);
+	uint64 ComputeNavigationHash() const;
+	void FinishNavigationBuild();
 	void InitializeNavigationGrid();
 	void ConstructNavigationNodes();
-	void ApplyThresholdBuffer();
+	void TraceGridPoints(const TArray<FVector>& LocalPoints, TArray<FGridTrace>& OutTraces) const;
+	void ApplyThresholdBuffer(const FIntRect& Region, TSet<FIntPoint>* OutChangedIDs = nullptr);
 	void CreateDebugGrid();
-	
-	TArray<FNavigationNode> FindThresholdNodes(TArray<FNavigationNode> SourceNodes);
+	void LabelComponents();
+	void RelabelComponents(const TArray<FIntPoint>& ChangedIDs);
+	void FloodComponent(int32 SeedIndex, int32 Label);
+	void MergeComponents(int32 KeptRoot, int32 MergedRoot);
+	void SplitComponent(const TArray<int32>& SeedIndices);
+	void CompactComponentLabels();
+	int32 FindValidNeighbor(const FIntPoint& ID, const FIntPoint& Offset) const;
+	void ComputeThresholdDistances(const FIntRect& Window, TArray<int64>& OutSquaredDistances) const;
+	bool IsThresholdNode(const FIntPoint& ID) const;
+
+	static void LowerEnvelope(const int64* Heights, int32 Num, int64* OutEnvelope, int32* Apexes, double* Bounds);
 };
@@ -0,0 +1,87 @@
+#include "NavigationGridCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Cache shared by every NavigationBuilder
+FNavigationGridCache& FNavigationGridCache::Get()
+{
+	static FNavigationGridCache Cache;
+	return Cache;
+}
+
+// Read the grid stored under Key with a single file read. Counts a hit or a miss
+bool FNavigationGridCache::Load(uint64 Key, FNavigationGridPayload& OutPayload)
+{
+	const FString EntryPath = GetEntryPath(Key);
+	if (FFileHelper::LoadFileToArray(OutPayload.Bytes, *EntryPath, FILEREAD_Silent) && OutPayload.GetHeader())
+	{
+		// The modification time doubles as the last use, so Trim keeps the entries still being loaded
+		IFileManager::Get().SetTimeStamp(*EntryPath, FDateTime::UtcNow());
+		++Hits;
+		return true;
+	}
+
+	OutPayload.Bytes.Reset();
+	++Misses;
+	return false;
+}
+
+// Store a built grid under Key, then trim the cache back to MaxSizeBytes
+void FNavigationGridCache::Store(uint64 Key, const FNavigationGridPayload& Payload)
+{
+	const FString EntryPath = GetEntryPath(Key);
+	if (!FFileHelper::SaveArrayToFile(Payload.Bytes, *EntryPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not write navigation cache entry %s"), *EntryPath);
+		return;
+	}
+
+	Trim(EntryPath);
+}
+
+// Delete the least recently used entries until the cache fits in MaxSizeBytes
+void FNavigationGridCache::Trim(const FString& KeepPath) const
+{
+	struct FEntry
+	{
+		FString Path;
+		FDateTime LastUsed;
+		int64 Size;
+	};
+
+	TArray<FEntry> Entries;
+	int64 TotalSize = 0;
+	IFileManager::Get().IterateDirectoryStat(*GetCacheDirectory(), [&Entries, &TotalSize](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		if (!StatData.bIsDirectory && FPaths::GetExtension(Path) == TEXT("navgrid"))
+		{
+			Entries.Add({ Path, StatData.ModificationTime, StatData.FileSize });
+			TotalSize += StatData.FileSize;
+		}
+		return true;
+	});
+
+	if (TotalSize <= MaxSizeBytes)
+		return;
+
+	Entries.Sort([](const FEntry& A, const FEntry& B) { return A.LastUsed < B.LastUsed; });
+	for (const FEntry& Entry : Entries)
+	{
+		if (TotalSize <= MaxSizeBytes)
+			break;
+
+		if (Entry.Path != KeepPath && IFileManager::Get().Delete(*Entry.Path, false, false, true))
+			TotalSize -= Entry.Size;
+	}
+}
+
+FString FNavigationGridCache::GetCacheDirectory() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("NavigationCache");
+}
+
+FString FNavigationGridCache::GetEntryPath(uint64 Key) const
+{
+	return GetCacheDirectory() / FString::Printf(TEXT("%016llx.navgrid"), Key);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationGridData.h"
+
+// Local derived-data cache of built navigation grids, one file per grid under Saved/NavigationCache
+// Entries are keyed by a hash of everything the build reads, so an entry never goes stale: changed inputs give another key
+// Every edit of a level leaves an entry behind, so the least recently used entries are deleted once the cache outgrows MaxSizeBytes
+class WALLCLIMBER_ANDRE_API FNavigationGridCache
+{
+public:
+	static constexpr int64 MaxSizeBytes = 256 * 1024 * 1024;
+
+	static FNavigationGridCache& Get();
+
+	// Read the grid stored under Key with a single file read. Counts a hit or a miss
+	bool Load(uint64 Key, FNavigationGridPayload& OutPayload);
+
+	// Store a built grid under Key, then trim the cache back to MaxSizeBytes
+	void Store(uint64 Key, const FNavigationGridPayload& Payload);
+
+	int32 GetHits() const { return Hits; }
+	int32 GetMisses() const { return Misses; }
+
+private:
+	FString GetCacheDirectory() const;
+	FString GetEntryPath(uint64 Key) const;
+
+	// Delete the least recently used entries until the cache fits in MaxSizeBytes. KeepPath is never deleted
+	void Trim(const FString& KeepPath) const;
+
+	int32 Hits = 0;
+	int32 Misses = 0;
+};
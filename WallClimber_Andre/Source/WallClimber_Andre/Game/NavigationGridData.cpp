@@ -0,0 +1,157 @@
+#include "NavigationGridData.h"
+
+namespace
+{
+	// Byte offsets of the payload sections described by a header
+	struct FBakeSections
+	{
+		int64 NodeBits;
+		int64 WalkableBits;
+		int64 ValidBits;
+		int64 Heights;
+		int64 ComponentLabels;
+		int64 End;
+
+		explicit FBakeSections(const FNavigationGridBakeHeader& Header)
+		{
+			const int64 BitBytes = FMath::DivideAndRoundUp<int64>(static_cast<int64>(Header.SizeX) * Header.SizeY, 64) * sizeof(uint64);
+			NodeBits = Align(sizeof(FNavigationGridBakeHeader), 8);
+			WalkableBits = NodeBits + BitBytes;
+			ValidBits = WalkableBits + BitBytes;
+			Heights = ValidBits + BitBytes;
+			ComponentLabels = Align(Heights + Header.NumNodes * static_cast<int64>(sizeof(float)), 8);
+			End = ComponentLabels + (Header.bHasComponentLabels ? Header.NumNodes * static_cast<int64>(sizeof(int32)) : 0);
+		}
+	};
+}
+
+void UNavigationGridData::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// One bulk read of the whole payload, nothing is deserialized node by node
+	Payload.Bytes.BulkSerialize(Ar);
+}
+
+// Replace the baked grid and mark the asset for saving
+void UNavigationGridData::Store(const FNavigationGridLayout& Layout, const FNavigationGridIndex& GridIndex, int32 ThresholdBuffer, const TArray<FNavigationNode>& Nodes,
+	const TArray<bool>& WalkableCells, const FNavigationComponentLabels& ComponentLabels)
+{
+	Payload.Store(Layout, GridIndex, ThresholdBuffer, Nodes, WalkableCells, ComponentLabels);
+	MarkPackageDirty();
+}
+
+// Replace the payload with a built grid
+void FNavigationGridPayload::Store(const FNavigationGridLayout& Layout, const FNavigationGridIndex& GridIndex, int32 ThresholdBuffer, const TArray<FNavigationNode>& Nodes,
+	const TArray<bool>& WalkableCells, const FNavigationComponentLabels& ComponentLabels)
+{
+	FNavigationGridBakeHeader Header = {};
+	Header.Magic = Magic;
+	Header.Version = CurrentVersion;
+	Header.SizeX = GridIndex.SizeX;
+	Header.SizeY = GridIndex.SizeY;
+	Header.NumNodes = Nodes.Num();
+	Header.ThresholdBuffer = ThresholdBuffer;
+	Header.bHasComponentLabels = ComponentLabels.Num() == Nodes.Num();
+	Header.Spacing = Layout.Spacing;
+
+	const FVector Translation = Layout.Transform.GetTranslation();
+	const FQuat Rotation = Layout.Transform.GetRotation();
+	const FVector Scale = Layout.Transform.GetScale3D();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Header.Extents[Axis] = Layout.Extents[Axis];
+		Header.Translation[Axis] = Translation[Axis];
+		Header.Scale[Axis] = Scale[Axis];
+	}
+	Header.Rotation[0] = Rotation.X;
+	Header.Rotation[1] = Rotation.Y;
+	Header.Rotation[2] = Rotation.Z;
+	Header.Rotation[3] = Rotation.W;
+
+	// Zeroed, so every bit starts cleared
+	const FBakeSections Sections(Header);
+	Bytes.Init(0, static_cast<int32>(Sections.End));
+	uint8* Data = Bytes.GetData();
+	FMemory::Memcpy(Data, &Header, sizeof(Header));
+
+	uint64* NodeBits = reinterpret_cast<uint64*>(Data + Sections.NodeBits);
+	uint64* WalkableBits = reinterpret_cast<uint64*>(Data + Sections.WalkableBits);
+	uint64* ValidBits = reinterpret_cast<uint64*>(Data + Sections.ValidBits);
+	float* Heights = reinterpret_cast<float*>(Data + Sections.Heights);
+
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		const FNavigationNode& Node = Nodes[NodeIndex];
+		const int32 Cell = Node.ID.X * GridIndex.SizeY + Node.ID.Y;
+		NodeBits[Cell >> 6] |= 1ULL << (Cell & 63);
+		if (Node.bIsValid)
+			ValidBits[Cell >> 6] |= 1ULL << (Cell & 63);
+		if (WalkableCells.IsValidIndex(Cell) && WalkableCells[Cell])
+			WalkableBits[Cell >> 6] |= 1ULL << (Cell & 63);
+
+		// The trace runs along the local Z axis, so the grid point and the local height give back the hit location
+		Heights[NodeIndex] = static_cast<float>(Layout.Transform.InverseTransformPosition(Node.Location).Z);
+	}
+
+	if (Header.bHasComponentLabels)
+	{
+		int32* Labels = reinterpret_cast<int32*>(Data + Sections.ComponentLabels);
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+			Labels[NodeIndex] = ComponentLabels.Find(NodeIndex);
+	}
+}
+
+// Header of the payload, nullptr when nothing of the current version is baked
+const FNavigationGridBakeHeader* FNavigationGridPayload::GetHeader() const
+{
+	if (Bytes.Num() < static_cast<int32>(sizeof(FNavigationGridBakeHeader)))
+		return nullptr;
+
+	const FNavigationGridBakeHeader* Header = reinterpret_cast<const FNavigationGridBakeHeader*>(Bytes.GetData());
+	if (Header->Magic != Magic || Header->Version != CurrentVersion || Header->SizeX < 0 || Header->SizeY < 0 || Header->NumNodes < 0)
+		return nullptr;
+
+	return FBakeSections(*Header).End <= Bytes.Num() ? Header : nullptr;
+}
+
+// Placement of the baked grid
+FNavigationGridLayout FNavigationGridPayload::GetLayout() const
+{
+	const FNavigationGridBakeHeader& Header = *GetHeader();
+
+	FNavigationGridLayout Layout;
+	Layout.Spacing = Header.Spacing;
+	Layout.Extents = FVector(Header.Extents[0], Header.Extents[1], Header.Extents[2]);
+	Layout.Transform = FTransform(
+		FQuat(Header.Rotation[0], Header.Rotation[1], Header.Rotation[2], Header.Rotation[3]),
+		FVector(Header.Translation[0], Header.Translation[1], Header.Translation[2]),
+		FVector(Header.Scale[0], Header.Scale[1], Header.Scale[2]));
+	return Layout;
+}
+
+const uint64* FNavigationGridPayload::GetNodeBits() const
+{
+	return reinterpret_cast<const uint64*>(Bytes.GetData() + FBakeSections(*GetHeader()).NodeBits);
+}
+
+const uint64* FNavigationGridPayload::GetWalkableBits() const
+{
+	return reinterpret_cast<const uint64*>(Bytes.GetData() + FBakeSections(*GetHeader()).WalkableBits);
+}
+
+const uint64* FNavigationGridPayload::GetValidBits() const
+{
+	return reinterpret_cast<const uint64*>(Bytes.GetData() + FBakeSections(*GetHeader()).ValidBits);
+}
+
+const float* FNavigationGridPayload::GetHeights() const
+{
+	return reinterpret_cast<const float*>(Bytes.GetData() + FBakeSections(*GetHeader()).Heights);
+}
+
+const int32* FNavigationGridPayload::GetComponentLabels() const
+{
+	const FNavigationGridBakeHeader& Header = *GetHeader();
+	return Header.bHasComponentLabels ? reinterpret_cast<const int32*>(Bytes.GetData() + FBakeSections(Header).ComponentLabels) : nullptr;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "NavigationBuilder.h"
+#include "NavigationGridData.generated.h"
+
+// Fixed-size start of a baked grid payload. The sections follow it in this order, each on an 8-byte boundary:
+// node bits, walkable bits and valid bits (one bit per grid cell, row-major like the grid index), the height of every node
+// in the builder's local space (one float per node, in node order) and, when bHasComponentLabels is set, the component labels (one int32 per node)
+struct FNavigationGridBakeHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	int32 SizeX;
+	int32 SizeY;
+	int32 NumNodes;
+	int32 ThresholdBuffer;
+	uint32 bHasComponentLabels;
+	float Spacing;
+	double Extents[3];
+	double Translation[3];
+	double Rotation[4];
+	double Scale[3];
+};
+
+// Final node grid of a NavigationBuilder as one flat block of bytes: a FNavigationGridBakeHeader followed by its sections
+// Everything is read in place, so loading it is a single bulk read of Bytes
+struct WALLCLIMBER_ANDRE_API FNavigationGridPayload
+{
+	static constexpr uint32 Magic = 0x4749564E; // "NVIG"
+
+	// Bump whenever the payload layout changes. Payloads of another version are ignored, so the builder traces instead
+	static constexpr uint32 CurrentVersion = 1;
+
+	TArray<uint8> Bytes;
+
+	// Replace the payload with a built grid. Nodes must be in grid order with no retired slots, as every full build leaves them
+	void Store(const FNavigationGridLayout& Layout, const FNavigationGridIndex& GridIndex, int32 ThresholdBuffer, const TArray<FNavigationNode>& Nodes,
+		const TArray<bool>& WalkableCells, const FNavigationComponentLabels& ComponentLabels);
+
+	// Header of the payload, nullptr when it holds nothing of the current version
+	const FNavigationGridBakeHeader* GetHeader() const;
+
+	// Placement of the grid. Only meaningful while GetHeader() is not null
+	FNavigationGridLayout GetLayout() const;
+
+	// Sections of the payload, see FNavigationGridBakeHeader. Only valid while GetHeader() is not null
+	const uint64* GetNodeBits() const;
+	const uint64* GetWalkableBits() const;
+	const uint64* GetValidBits() const;
+	const float* GetHeights() const;
+	const int32* GetComponentLabels() const; // nullptr when the labels were not stored
+
+	static bool IsBitSet(const uint64* Words, int32 Index)
+	{
+		return ((Words[Index >> 6] >> (Index & 63)) & 1) != 0;
+	}
+};
+
+// Final node grid of a NavigationBuilder, baked in the editor so the level does not trace it again when it loads
+UCLASS(BlueprintType)
+class WALLCLIMBER_ANDRE_API UNavigationGridData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+
+	// Replace the baked grid and mark the asset for saving
+	void Store(const FNavigationGridLayout& Layout, const FNavigationGridIndex& GridIndex, int32 ThresholdBuffer, const TArray<FNavigationNode>& Nodes,
+		const TArray<bool>& WalkableCells, const FNavigationComponentLabels& ComponentLabels);
+
+	const FNavigationGridPayload& GetPayload() const { return Payload; }
+
+private:
+	FNavigationGridPayload Payload;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Array kept in fixed-size pages that copies of it share until one of them writes
+// Copying the array only copies the page pointers, and a write clones the page it lands in when another copy still holds that page.
+// Per-node and per-cell tables use it, so a new version of a table costs the pages an edit writes to, not the whole table
+// Reads may run on any thread. Writes to one array must stay on one thread, since two writes can clone the same page
+template <typename ElementType>
+class TNavigationPagedArray
+{
+public:
+	static constexpr int32 PageBits = 12;
+	static constexpr int32 PageSize = 1 << PageBits;
+	static constexpr int32 PageMask = PageSize - 1;
+
+	int32 Num() const { return NumElements; }
+
+	bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumElements; }
+
+	const ElementType& operator[](int32 Index) const
+	{
+		checkSlow(IsValidIndex(Index));
+		return Pages[Index >> PageBits]->Elements[Index & PageMask];
+	}
+
+	// Element to write to. Its page is cloned first when another copy of the array still shares it
+	ElementType& GetMutable(int32 Index)
+	{
+		checkSlow(IsValidIndex(Index));
+		TSharedPtr<FPage, ESPMode::ThreadSafe>& Page = Pages[Index >> PageBits];
+		if (!Page.IsUnique())
+		{
+			Page = MakeShared<FPage, ESPMode::ThreadSafe>(*Page);
+		}
+		return Page->Elements[Index & PageMask];
+	}
+
+	// Replace the contents with Count copies of Value, on pages of its own
+	void Init(const ElementType& Value, int32 Count)
+	{
+		Reset();
+		SetNum(Count, Value);
+	}
+
+	// Grow or shrink to Count elements. Elements added are set to Value
+	void SetNum(int32 Count, const ElementType& Value = ElementType())
+	{
+		const int32 NumPages = (Count + PageMask) >> PageBits;
+		if (Count > NumElements)
+		{
+			// The last page may be shared and only partly used
+			if ((NumElements & PageMask) != 0)
+			{
+				GetMutable(NumElements - 1);
+			}
+			while (Pages.Num() < NumPages)
+			{
+				Pages.Add(MakeShared<FPage, ESPMode::ThreadSafe>());
+			}
+			for (int32 Index = NumElements; Index < Count; ++Index)
+			{
+				Pages[Index >> PageBits]->Elements[Index & PageMask] = Value;
+			}
+		}
+		else
+		{
+			Pages.SetNum(NumPages);
+		}
+		NumElements = Count;
+	}
+
+	// Append an element and return its index
+	int32 Add(const ElementType& Value)
+	{
+		SetNum(NumElements + 1, Value);
+		return NumElements - 1;
+	}
+
+	void Reset()
+	{
+		Pages.Reset();
+		NumElements = 0;
+	}
+
+	// Index of an element handed out by operator[], INDEX_NONE if it points elsewhere. Walks the pages, not the elements
+	int32 IndexOf(const ElementType* Element) const
+	{
+		for (int32 PageIndex = 0; PageIndex < Pages.Num(); ++PageIndex)
+		{
+			const ElementType* First = Pages[PageIndex]->Elements;
+			if (Element >= First && Element < First + PageSize)
+			{
+				const int32 Index = (PageIndex << PageBits) + static_cast<int32>(Element - First);
+				return IsValidIndex(Index) ? Index : INDEX_NONE;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	// Memory held by the pages, counted in full even while other copies share them
+	int64 GetAllocatedSize() const
+	{
+		return Pages.Num() * static_cast<int64>(sizeof(FPage)) + Pages.GetAllocatedSize();
+	}
+
+private:
+	struct FPage
+	{
+		ElementType Elements[PageSize];
+	};
+
+	TArray<TSharedPtr<FPage, ESPMode::ThreadSafe>> Pages;
+	int32 NumElements = 0;
+};
@@ -5,10 +5,19 @@
 */
 
 #include "PathfindingComponent.h"
+#include "PathfindingHierarchy.h"
+#include "PathfindingSubsystem.h"
 #include "EngineUtils.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
 
 // Constructor
 UPathfindingComponent::UPathfindingComponent()
+    : PathCache(MakeShared<FPathfindingPathCache, ESPMode::ThreadSafe>())
 {
     PrimaryComponentTick.bCanEverTick = false;
 }
@@ -17,172 +26,546 @@ UPathfindingComponent::UPathfindingComponent()
 void UPathfindingComponent::BeginPlay()
 {
     Super::BeginPlay();
+    PathCache->SetCapacity(PathCacheCapacity);
     InitializePathfinding();
 }
 
+// Called when the component is removed from play, cancels pending requests
+void UPathfindingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (const TPair<uint32, TSharedRef<FPathRequestState, ESPMode::ThreadSafe>>& Request : PendingRequests)
+    {
+        Request.Value->bCancelled = true;
+    }
+    PendingRequests.Empty();
+    LatestRequestByRequester.Empty();
+
+    // The subsystem may already be gone when the world is torn down
+    if (UPathfindingSubsystem* PathfindingSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UPathfindingSubsystem>() : nullptr)
+    {
+        PathfindingSubsystem->OnGraphUpdated.Remove(GraphUpdatedHandle);
+    }
+    GraphUpdatedHandle.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
 // Initializes pathfinding nodes from the NavigationBuilder
 void UPathfindingComponent::InitializePathfinding()
 {
-    // Find the NavigationBuilder in the world and initialize pathfinding nodes
+    UPathfindingSubsystem* PathfindingSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+    if (!PathfindingSubsystem)
+    {
+        return;
+    }
+
+    // Find the NavigationBuilder in the world and share the pathfinding graph the subsystem keeps for it
     for (TActorIterator<ANavigationBuilder> It(GetWorld()); It; ++It)
     {
-        NavBuilder = *It;
-        if (NavBuilder)
+        ANavigationBuilder* Builder = *It;
+        if (Builder)
         {
             UE_LOG(LogTemp, Warning, TEXT("NavBuilder found"));
-            const auto& NavNodes = NavBuilder->GetNavigationNodesArray();
-            UE_LOG(LogTemp, Warning, TEXT("NavBuilder has %d nodes"), NavNodes.Num());
-
-            // Convert FNavigationNode to FPathfindingNode and store them
-            for (const FNavigationNode& Node : NavNodes)
-            {
-                FPathfindingNode NewNode;
-                NewNode.Location = Node.Location;
-                NewNode.ID = Node.ID;
-                NewNode.bIsValid = Node.bIsValid;
-                PathfindingNodes.Add(NewNode);
-                //UE_LOG(LogTemp, Warning, TEXT("Added Node ID: %s, Location: %s"), *NewNode.ID.ToString(), *NewNode.Location.ToString());
-            }
+            NavBuilder = Builder;
+            Graph = PathfindingSubsystem->AcquireGraph(*Builder, NumLandmarks, LandmarkMemoryBudgetMB * 1024LL * 1024LL);
+            PathfindingSubsystem->OnGraphUpdated.Remove(GraphUpdatedHandle);
+            GraphUpdatedHandle = PathfindingSubsystem->OnGraphUpdated.AddUObject(this, &UPathfindingComponent::HandleGraphUpdated);
+            UE_LOG(LogTemp, Warning, TEXT("NavBuilder has %d nodes"), Graph->Num());
             break;
         }
     }
 
-    UE_LOG(LogTemp, Warning, TEXT("PathfindingNodes initialized with %d nodes"), PathfindingNodes.Num());
+    UE_LOG(LogTemp, Warning, TEXT("PathfindingNodes initialized with %d nodes"), Graph ? Graph->Num() : 0);
+}
+
+// Picks up the graph the subsystem rebuilt after the NavigationBuilder edited or rebuilt its nodes
+void UPathfindingComponent::HandleGraphUpdated(const ANavigationBuilder* UpdatedBuilder, const TArray<FIntPoint>& ChangedIDs)
+{
+    UPathfindingSubsystem* PathfindingSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+    if (!PathfindingSubsystem || !UpdatedBuilder || UpdatedBuilder != NavBuilder.Get())
+    {
+        return;
+    }
+
+    Graph = PathfindingSubsystem->GetGraph(UpdatedBuilder);
+
+    // The incremental search only repairs the nodes around the edit
+    if (IncrementalSearch.GetGraph())
+    {
+        IncrementalSearch.UpdateGraph(Graph, ChangedIDs);
+    }
 }
 
 
-// Finds a path between two locations using the A* algorithm
-TArray<FPathfindingNode> UPathfindingComponent::FindPath(const FVector& StartLocation, const FVector& EndLocation)
+// Finds a path between two locations using the given search algorithm
+TArray<FPathfindingNode> UPathfindingComponent::FindPath(const FVector& StartLocation, const FVector& EndLocation, EPathfindingSearchMode SearchMode)
 {
-    FPathfindingNode* StartNode = GetClosestNode(StartLocation);
-    FPathfindingNode* EndNode = GetClosestNode(EndLocation);
+    FPathfindingPath Path;
+    FindPath(StartLocation, EndLocation, Path, SearchMode);
+    return Path.ToPathNodes();
+}
 
-    if (StartNode && EndNode)
+// Finds a path between two locations into a compact path backed by a pooled buffer
+bool UPathfindingComponent::FindPath(const FVector& StartLocation, const FVector& EndLocation, FPathfindingPath& OutPath, EPathfindingSearchMode SearchMode)
+{
+    if (!Graph)
     {
-        return CalculateAStarPath(StartNode, EndNode);
+        OutPath.Reset();
+        return false;
     }
 
-    return TArray<FPathfindingNode>();
+    // D* Lite runs on the latest topology, the other modes on the latest graph with complete search tables. Node indices are resolved on that graph
+    if (SearchMode == EPathfindingSearchMode::Incremental)
+    {
+        return SearchIncrementalPath(Graph->FindClosestNode(StartLocation), Graph->FindClosestNode(EndLocation), OutPath);
+    }
+    const FPathfindingGraphPtr SearchGraph = GetSearchGraph();
+    return SearchPath(SearchGraph->FindClosestNode(StartLocation), SearchGraph->FindClosestNode(EndLocation), SearchMode, SearchContext, OutPath);
 }
 
-// Finds the closest pathfinding node to a given location
-FPathfindingNode* UPathfindingComponent::GetClosestNode(const FVector& Location)
+// Index of the closest pathfinding node to a given location
+int32 UPathfindingComponent::GetClosestNodeIndex(const FVector& Location) const
 {
-    FPathfindingNode* ClosestNode = nullptr;
-    float ClosestDistanceSquared = FLT_MAX;
+    if (!Graph)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Pathfinding not initialized"));
+        return INDEX_NONE;
+    }
 
-    //UE_LOG(LogTemp, Warning, TEXT("PathfindingNodes Count: %d"), PathfindingNodes.Num());
+    const int32 ClosestIndex = Graph->FindClosestNode(Location);
+    if (ClosestIndex == INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("No Closest Node Found"));
+    }
+    return ClosestIndex;
+}
 
-    for (FPathfindingNode& Node : PathfindingNodes)
+// Index of the closest pathfinding node to each location
+void UPathfindingComponent::GetClosestNodeIndices(const TArray<FVector>& Locations, TArray<int32>& OutNodeIndices) const
+{
+    if (!Graph)
     {
-        if (Node.bIsValid)
-        {
-            float DistanceSquared = FVector::DistSquared(Location, Node.Location);
-            //UE_LOG(LogTemp, Warning, TEXT("Checking Node at %s, DistanceSquared: %f"), *Node.Location.ToString(), DistanceSquared);
+        UE_LOG(LogTemp, Warning, TEXT("Pathfinding not initialized"));
+        OutNodeIndices.Init(INDEX_NONE, Locations.Num());
+        return;
+    }
 
-            if (DistanceSquared < ClosestDistanceSquared)
-            {
-                ClosestNode = &Node;
-                ClosestDistanceSquared = DistanceSquared;
-            }
-        }
+    Graph->FindClosestNodes(Locations, OutNodeIndices);
+}
+
+// USTRUCT view of a node, built from the graph on demand
+FPathfindingNode UPathfindingComponent::GetNode(int32 NodeIndex) const
+{
+    return Graph && Graph->IsValidIndex(NodeIndex) ? Graph->GetNode(NodeIndex) : FPathfindingNode();
+}
+
+// Calculates the shortest path between two nodes using the A* algorithm
+TArray<FPathfindingNode> UPathfindingComponent::CalculateAStarPath(int32 StartIndex, int32 EndIndex)
+{
+    return CalculatePath(StartIndex, EndIndex, EPathfindingSearchMode::AStar, SearchContext);
+}
+
+// Calculates the shortest path using caller-owned scratch state
+TArray<FPathfindingNode> UPathfindingComponent::CalculateAStarPath(int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context) const
+{
+    return CalculatePath(StartIndex, EndIndex, EPathfindingSearchMode::AStar, Context);
+}
+
+// Calculates the shortest path between two nodes using the given search algorithm
+TArray<FPathfindingNode> UPathfindingComponent::CalculatePath(int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode)
+{
+    if (SearchMode == EPathfindingSearchMode::Incremental && Graph)
+    {
+        FPathfindingPath Path;
+        SearchIncrementalPath(StartIndex, EndIndex, Path);
+        return Path.ToPathNodes();
     }
 
-    if (ClosestNode)
+    return CalculatePath(StartIndex, EndIndex, SearchMode, SearchContext);
+}
+
+// Calculates the shortest path using the given search algorithm and caller-owned scratch state
+TArray<FPathfindingNode> UPathfindingComponent::CalculatePath(int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode, FPathfindingSearchContext& Context) const
+{
+    if (!Graph)
     {
-        //UE_LOG(LogTemp, Warning, TEXT("Closest Node Found at %s"), *ClosestNode->Location.ToString());
+        return TArray<FPathfindingNode>();
     }
-    else
+
+    // Empty if no path was found
+    FPathfindingPath Path;
+    SearchPath(StartIndex, EndIndex, SearchMode, Context, Path);
+    return Path.ToPathNodes();
+}
+
+// Runs the selected search algorithm between two node indices, answering from the path cache when it holds the path
+bool UPathfindingComponent::RunSearch(const FPathfindingGraph& SearchGraph, int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode, const FPathfindingSearchPolicies& Policies,
+    FPathfindingSearchContext& Context, TArray<int32>& OutPath, FPathfindingPathCache* Cache)
+{
+    // Nodes in different connected components cannot be joined, no search needs to find that out
+    if (!SearchGraph.AreConnected(StartIndex, EndIndex))
     {
-        UE_LOG(LogTemp, Warning, TEXT("No Closest Node Found"));
+        OutPath.Reset();
+        return false;
+    }
+
+    // Paths found under other policies may differ, so the policies are part of the cache key. Modes take the low three bits
+    const bool bUsesPolicies = SearchMode == EPathfindingSearchMode::AStar || SearchMode == EPathfindingSearchMode::Incremental;
+    const uint8 SearchKey = static_cast<uint8>(SearchMode) | (bUsesPolicies ? Policies.GetKey() << 3 : 0);
+
+    if (Cache && Cache->Find(StartIndex, EndIndex, SearchKey, SearchGraph.NavigationVersion, OutPath))
+    {
+        return true;
+    }
+
+    bool bFound = false;
+    switch (SearchMode)
+    {
+    case EPathfindingSearchMode::JumpPointSearch:
+        bFound = PathfindingSearch::FindJumpPointPath(SearchGraph, StartIndex, EndIndex, Context, OutPath);
+        break;
+    case EPathfindingSearchMode::Bidirectional:
+        bFound = PathfindingSearch::FindBidirectionalAStarPath(SearchGraph, StartIndex, EndIndex, Context, OutPath);
+        break;
+    case EPathfindingSearchMode::Hierarchical:
+        bFound = PathfindingSearch::FindHierarchicalPath(SearchGraph, StartIndex, EndIndex, Context, OutPath);
+        break;
+    case EPathfindingSearchMode::AStar:
+    case EPathfindingSearchMode::Incremental:
+    default:
+        bFound = PathfindingKernels::FindPath(SearchGraph, StartIndex, EndIndex, Context, OutPath, Policies);
+        break;
     }
 
-    return ClosestNode;
+    if (bFound && Cache)
+    {
+        Cache->Add(StartIndex, EndIndex, SearchKey, SearchGraph.NavigationVersion, OutPath);
+    }
+    return bFound;
 }
 
+// Runs a search with the path cache into OutPath on the current graph
+bool UPathfindingComponent::SearchPath(int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode, FPathfindingSearchContext& Context, FPathfindingPath& OutPath) const
+{
+    const FPathfindingGraphPtr SearchGraph = GetSearchGraph();
+    OutPath.Initialize(SearchGraph);
+    const int32 GoalIndex = ResolveGoal(*SearchGraph, StartIndex, EndIndex, bRedirectUnreachableGoals);
+    return FinishPath(RunSearch(*SearchGraph, StartIndex, GoalIndex, SearchMode, SearchPolicies, Context, OutPath.GetNodeIndices(), &PathCache.Get()), bAnyAnglePaths, OutPath);
+}
 
-// Calculates the shortest path between two nodes using the A* algorithm
-TArray<FPathfindingNode> UPathfindingComponent::CalculateAStarPath(FPathfindingNode* StartNode, FPathfindingNode* EndNode)
+// Latest graph whose search tables are complete
+FPathfindingGraphPtr UPathfindingComponent::GetSearchGraph() const
+{
+    if (!Graph || !Graph->HasPendingSearchTables())
+    {
+        return Graph;
+    }
+
+    // The subsystem repairs the shared graph on a worker once for every component. Until it is done, searches run on the graph before the edit
+    const UPathfindingSubsystem* PathfindingSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+    const FPathfindingGraphPtr SearchGraph = PathfindingSubsystem ? PathfindingSubsystem->GetSearchGraph(NavBuilder.Get()) : FPathfindingGraphPtr();
+    return SearchGraph ? SearchGraph : FPathfindingGraph::CompleteSearchTables(*Graph);
+}
+
+// Goal a query searches for: EndIndex, or with bRedirect the closest node the start can reach if EndIndex is cut off from it
+int32 UPathfindingComponent::ResolveGoal(const FPathfindingGraph& SearchGraph, int32 StartIndex, int32 EndIndex, bool bRedirect)
 {
-    // The open set, nodes to be evaluated
-    TArray<FPathfindingNode*> OpenSet;
-    // The closed set, nodes already evaluated
-    TSet<FPathfindingNode*> ClosedSet;
+    return bRedirect ? SearchGraph.FindClosestConnectedNode(StartIndex, EndIndex) : EndIndex;
+}
 
-    // Add the start node to the open set
-    OpenSet.Add(StartNode);
+// Keeps a found path, string-pulled to corner waypoints if bAnyAngle is set, and hands the buffer of a failed one back to the pool
+bool UPathfindingComponent::FinishPath(bool bFound, bool bAnyAngle, FPathfindingPath& Path)
+{
+    if (!bFound)
+    {
+        Path.Reset();
+        return false;
+    }
+
+    if (bAnyAngle)
+    {
+        PathfindingSearch::StringPullPath(*Path.GetGraph(), Path.GetNodeIndices());
+    }
+    return true;
+}
+
+// Replans with the component's D* Lite state into OutPath, starting it over when the goal or the grid changed
+bool UPathfindingComponent::SearchIncrementalPath(int32 StartIndex, int32 EndIndex, FPathfindingPath& OutPath)
+{
+    // D* Lite would settle the goal's whole component before giving up on a goal the start cannot reach
+    EndIndex = ResolveGoal(*Graph, StartIndex, EndIndex, bRedirectUnreachableGoals);
+    if (!Graph->AreConnected(StartIndex, EndIndex))
+    {
+        OutPath.Reset();
+        return false;
+    }
 
-    // While the open set is not empty
-    while (OpenSet.Num() > 0)
+    if (IncrementalSearch.IsInitializedFor(Graph, EndIndex))
     {
-        // Find the node in the open set with the lowest F score
-        FPathfindingNode* CurrentNode = OpenSet[0];
-        for (int32 i = 1; i < OpenSet.Num(); ++i)
+        IncrementalSearch.MoveStart(StartIndex);
+    }
+    else
+    {
+        IncrementalSearch.Initialize(Graph, StartIndex, EndIndex);
+    }
+
+    OutPath.Initialize(Graph);
+    return FinishPath(IncrementalSearch.Replan(OutPath.GetNodeIndices()), bAnyAnglePaths, OutPath);
+}
+
+// Queues a path search on the worker pool and returns immediately
+FPathRequestHandle UPathfindingComponent::RequestPathAsync(const FVector& StartLocation, const FVector& EndLocation, FOnPathRequestComplete OnComplete,
+    EPathRequestPriority Priority, EPathfindingSearchMode SearchMode, const UObject* Requester)
+{
+    const TSharedRef<FPathRequestState, ESPMode::ThreadSafe> State = CreatePathRequest(Requester);
+
+    // The worker only sees the immutable graph and the shared request state
+    const FPathfindingGraphPtr SearchGraph = GetSearchGraph();
+    const TSharedRef<FPathfindingPathCache, ESPMode::ThreadSafe> Cache = PathCache;
+    const TWeakObjectPtr<UPathfindingComponent> WeakThis(this);
+    const bool bAnyAngle = bAnyAnglePaths;
+    const bool bRedirectGoal = bRedirectUnreachableGoals;
+    const FPathfindingSearchPolicies Policies = SearchPolicies;
+
+    UE::Tasks::ETaskPriority TaskPriority = UE::Tasks::ETaskPriority::Normal;
+    switch (Priority)
+    {
+    case EPathRequestPriority::Player:
+        TaskPriority = UE::Tasks::ETaskPriority::High;
+        break;
+    case EPathRequestPriority::Ambient:
+        TaskPriority = UE::Tasks::ETaskPriority::BackgroundNormal;
+        break;
+    default:
+        break;
+    }
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [SearchGraph, Cache, StartLocation, EndLocation, SearchMode, Policies, bAnyAngle, bRedirectGoal, State, WeakThis, OnComplete]()
+    {
+        FPathfindingPath Path;
+        if (SearchGraph && !State->bCancelled)
+        {
+            FScopedPathfindingSearchContext Context;
+            Context->SetCancellationFlag(&State->bCancelled);
+
+            const int32 StartIndex = SearchGraph->FindClosestNode(StartLocation);
+            const int32 EndIndex = ResolveGoal(*SearchGraph, StartIndex, SearchGraph->FindClosestNode(EndLocation), bRedirectGoal);
+            Path.Initialize(SearchGraph);
+            FinishPath(RunSearch(*SearchGraph, StartIndex, EndIndex, SearchMode, Policies, *Context, Path.GetNodeIndices(), &Cache.Get()), bAnyAngle, Path);
+        }
+
+        // Report back on the game thread, where the component and its delegates live. The path is moved along, never copied
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, State, Path = MoveTemp(Path), OnComplete]() mutable
         {
-            if (OpenSet[i]->FCost < CurrentNode->FCost)
+            if (UPathfindingComponent* This = WeakThis.Get())
             {
-                CurrentNode = OpenSet[i];
+                This->CompletePathRequest(State, Path, OnComplete);
             }
-        }
+        });
+    }, TaskPriority);
+
+    return State->Handle;
+}
+
+// Starts an A* search that the pathfinding subsystem spreads over frames within its global per-frame budget
+FPathRequestHandle UPathfindingComponent::RequestPathTimeSliced(const FVector& StartLocation, const FVector& EndLocation, FOnPathRequestComplete OnComplete, const UObject* Requester)
+{
+    const TSharedRef<FPathRequestState, ESPMode::ThreadSafe> State = CreatePathRequest(Requester);
 
-        // If the current node is the end node, reconstruct the path and return it
-        if (CurrentNode == EndNode)
+    UPathfindingSubsystem* PathfindingSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+    const FPathfindingGraphPtr SearchGraph = GetSearchGraph();
+    const int32 StartIndex = SearchGraph ? SearchGraph->FindClosestNode(StartLocation) : INDEX_NONE;
+    const int32 EndIndex = SearchGraph ? ResolveGoal(*SearchGraph, StartIndex, SearchGraph->FindClosestNode(EndLocation), bRedirectUnreachableGoals) : INDEX_NONE;
+
+    // Without the subsystem nothing would step the search, so the request fails on the next frame
+    if (!PathfindingSubsystem)
+    {
+        const TWeakObjectPtr<UPathfindingComponent> WeakThis(this);
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, State, OnComplete]()
         {
-            TArray<FPathfindingNode> Path;
-            while (CurrentNode != nullptr)
+            if (UPathfindingComponent* This = WeakThis.Get())
             {
-                Path.Add(*CurrentNode);
-                CurrentNode = (CurrentNode->ParentIndex != INDEX_NONE) ? &PathfindingNodes[CurrentNode->ParentIndex] : nullptr;
+                FPathfindingPath NoPath;
+                This->CompletePathRequest(State, NoPath, OnComplete);
             }
-            Algo::Reverse(Path);
-            return Path;
+        });
+        return State->Handle;
+    }
+
+    const TSharedRef<FPathfindingTimeSlicedSearch> Search = MakeShared<FPathfindingTimeSlicedSearch>(SearchGraph, StartIndex, EndIndex, &State->bCancelled);
+    PathfindingSubsystem->AddTimeSlicedSearch(Search, FOnTimeSlicedSearchComplete::CreateWeakLambda(this, [this, State, OnComplete](FPathfindingTimeSlicedSearch& FinishedSearch)
+    {
+        FPathfindingPath& Path = FinishedSearch.GetPath();
+        FinishPath(FinishedSearch.GetStatus() == EPathSearchStatus::Succeeded, bAnyAnglePaths, Path);
+        CompletePathRequest(State, Path, OnComplete);
+    }));
+
+    return State->Handle;
+}
+
+// Finds paths for many start/goal pairs at once and returns them in query order
+TArray<FPathfindingPath> UPathfindingComponent::FindPathsBatch(const TArray<FPathQuery>& Queries, EPathfindingSearchMode SearchMode, int32 MaxWorkers) const
+{
+    TArray<FPathfindingPath> Paths;
+    Paths.SetNum(Queries.Num());
+    if (!Graph || Queries.Num() == 0)
+    {
+        return Paths;
+    }
+
+    const FPathfindingGraphPtr SearchGraphPtr = GetSearchGraph();
+    const FPathfindingGraph& SearchGraph = *SearchGraphPtr;
+
+    // Resolve every start and end node in one pass before any search runs
+    TArray<FVector> EndpointLocations;
+    EndpointLocations.Reserve(Queries.Num() * 2);
+    for (const FPathQuery& Query : Queries)
+    {
+        EndpointLocations.Add(Query.StartLocation);
+        EndpointLocations.Add(Query.EndLocation);
+    }
+    TArray<int32> EndpointIndices;
+    SearchGraph.FindClosestNodes(EndpointLocations, EndpointIndices);
+
+    // Each worker borrows one context and keeps pulling the next query, so uneven search costs balance out
+    const int32 NumWorkers = FMath::Clamp(MaxWorkers > 0 ? MaxWorkers : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, Queries.Num());
+    FPathfindingPathCache& Cache = PathCache.Get();
+    std::atomic<int32> NextQuery{ 0 };
+    const bool bAnyAngle = bAnyAnglePaths;
+    const bool bRedirectGoal = bRedirectUnreachableGoals;
+    const FPathfindingSearchPolicies& Policies = SearchPolicies;
+    ParallelFor(NumWorkers, [&SearchGraph, &SearchGraphPtr, &Cache, &EndpointIndices, &Paths, &NextQuery, &Policies, SearchMode, bAnyAngle, bRedirectGoal](int32)
+    {
+        FScopedPathfindingSearchContext Context;
+        for (int32 QueryIndex = NextQuery++; QueryIndex < Paths.Num(); QueryIndex = NextQuery++)
+        {
+            FPathfindingPath& Path = Paths[QueryIndex];
+            const int32 StartIndex = EndpointIndices[QueryIndex * 2];
+            const int32 EndIndex = ResolveGoal(SearchGraph, StartIndex, EndpointIndices[QueryIndex * 2 + 1], bRedirectGoal);
+            Path.Initialize(SearchGraphPtr);
+            FinishPath(RunSearch(SearchGraph, StartIndex, EndIndex, SearchMode, Policies, *Context, Path.GetNodeIndices(), &Cache), bAnyAngle, Path);
         }
+    });
 
-        // Move the current node from the open set to the closed set
-        OpenSet.Remove(CurrentNode);
-        ClosedSet.Add(CurrentNode);
+    return Paths;
+}
+
+// Runs the same batch of random queries with 1, 2, 4... workers up to the core count and logs the throughput of each run
+void UPathfindingComponent::BenchmarkBatchPathfinding(int32 NumQueries, EPathfindingSearchMode SearchMode) const
+{
+    if (!Graph || NumQueries <= 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Pathfinding not initialized"));
+        return;
+    }
 
-        // For each neighbor of the current node
-        for (const FIntPoint NeighborOffset : NavBuilder->GetCircularNeighbors(1))
+    TArray<int32> ValidNodes;
+    for (int32 NodeIndex = 0; NodeIndex < Graph->Num(); ++NodeIndex)
+    {
+        if (Graph->IsNodeValid(NodeIndex))
         {
-            FIntPoint NeighborID = CurrentNode->ID + NeighborOffset;
+            ValidNodes.Add(NodeIndex);
+        }
+    }
+    if (ValidNodes.Num() == 0)
+    {
+        return;
+    }
 
-            FPathfindingNode* NeighborNode = nullptr;
-            for (FPathfindingNode& Node : PathfindingNodes)
-            {
-                if (Node.ID == NeighborID && Node.bIsValid)
-                {
-                    NeighborNode = &Node;
-                    break;
-                }
-            }
+    // Fixed seed so every run searches the same pairs
+    FRandomStream Random(1234);
+    TArray<FPathQuery> Queries;
+    Queries.SetNum(NumQueries);
+    for (FPathQuery& Query : Queries)
+    {
+        Query.StartLocation = Graph->NodeLocations[ValidNodes[Random.RandHelper(ValidNodes.Num())]];
+        Query.EndLocation = Graph->NodeLocations[ValidNodes[Random.RandHelper(ValidNodes.Num())]];
+    }
 
+    const int32 MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    double SingleWorkerSeconds = 0.0;
+    for (int32 NumWorkers = 1; ; NumWorkers = FMath::Min(NumWorkers * 2, MaxWorkers))
+    {
+        // Every run has to search, not replay the paths cached by the previous run
+        PathCache->Empty();
 
+        const double StartTime = FPlatformTime::Seconds();
+        const TArray<FPathfindingPath> Paths = FindPathsBatch(Queries, SearchMode, NumWorkers);
+        const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_DOUBLE_SMALL_NUMBER);
 
-            if (NeighborNode && !ClosedSet.Contains(NeighborNode))
-            {
-                // The distance from start to the neighbor
-                int32 MovementCost = (FMath::Abs(NeighborOffset.X) + FMath::Abs(NeighborOffset.Y) == 1) ? 10 : 14; // Cross shape cost is 10, diagonal (X shape) cost is 14
-                int32 TentativeGScore = CurrentNode->GCost + MovementCost;
-
-                if (!OpenSet.Contains(NeighborNode))
-                {
-                    OpenSet.Add(NeighborNode);
-                }
-                else if (TentativeGScore >= NeighborNode->GCost)
-                {
-                    continue; // This is not a better path
-                }
-
-                // This path is the best so far, record it
-                NeighborNode->ParentIndex = PathfindingNodes.IndexOfByKey(*CurrentNode);
-                NeighborNode->GCost = TentativeGScore;
-                NeighborNode->HCost = FMath::Abs(NeighborID.X - EndNode->ID.X) + FMath::Abs(NeighborID.Y - EndNode->ID.Y); // Manhattan distance as heuristic
-                NeighborNode->FCost = NeighborNode->GCost + NeighborNode->HCost; // Update FCost
-            }
+        if (NumWorkers == 1)
+        {
+            SingleWorkerSeconds = Seconds;
+        }
+
+        int32 NumFound = 0;
+        for (const FPathfindingPath& Path : Paths)
+        {
+            NumFound += Path.Num() > 0 ? 1 : 0;
         }
+
+        UE_LOG(LogTemp, Warning, TEXT("Batch pathfinding: %d workers, %d queries (%d found) in %.2f ms, %.0f queries/s, %.2fx speedup"),
+            NumWorkers, NumQueries, NumFound, Seconds * 1000.0, NumQueries / Seconds, SingleWorkerSeconds / Seconds);
+
+        if (NumWorkers == MaxWorkers)
+        {
+            break;
+        }
+    }
+}
+
+// Flow field toward the node closest to GoalLocation, shared with every other agent heading there
+TSharedPtr<const FPathfindingFlowField, ESPMode::ThreadSafe> UPathfindingComponent::AcquireFlowField(const FVector& GoalLocation) const
+{
+    UPathfindingSubsystem* PathfindingSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+    if (!Graph || !PathfindingSubsystem)
+    {
+        return nullptr;
+    }
+
+    return PathfindingSubsystem->AcquireFlowField(*Graph, Graph->FindClosestNode(GoalLocation));
+}
+
+// Cancels a pending request. Its completion delegate will not run
+void UPathfindingComponent::CancelPathRequest(FPathRequestHandle Handle)
+{
+    if (const TSharedRef<FPathRequestState, ESPMode::ThreadSafe>* State = PendingRequests.Find(Handle.RequestId))
+    {
+        (*State)->bCancelled = true;
+        PendingRequests.Remove(Handle.RequestId);
+    }
+}
+
+// Registers a new pending request, cancelling the previous request of the same Requester
+TSharedRef<FPathRequestState, ESPMode::ThreadSafe> UPathfindingComponent::CreatePathRequest(const UObject* Requester)
+{
+    TSharedRef<FPathRequestState, ESPMode::ThreadSafe> State = MakeShared<FPathRequestState, ESPMode::ThreadSafe>();
+    State->Handle.RequestId = NextRequestId++;
+    if (NextRequestId == 0)
+    {
+        NextRequestId = 1; // Zero is the invalid handle
+    }
+    PendingRequests.Add(State->Handle.RequestId, State);
+
+    // A newer request from the same requester supersedes the previous one
+    if (Requester)
+    {
+        uint32& LatestRequestId = LatestRequestByRequester.FindOrAdd(FObjectKey(Requester));
+        CancelPathRequest(FPathRequestHandle{ LatestRequestId });
+        LatestRequestId = State->Handle.RequestId;
+    }
+
+    return State;
+}
+
+// Reports a finished asynchronous request on the game thread
+void UPathfindingComponent::CompletePathRequest(const TSharedRef<FPathRequestState, ESPMode::ThreadSafe>& State, FPathfindingPath& Path, FOnPathRequestComplete OnComplete)
+{
+    // Cancelled or superseded requests are dropped silently
+    if (State->bCancelled || PendingRequests.Remove(State->Handle.RequestId) == 0)
+    {
+        return;
     }
 
-    // If we get here, there was no path found
-    return TArray<FPathfindingNode>();
+    OnComplete.ExecuteIfBound(State->Handle, Path);
 }
@@ -1,7 +1,7 @@
 /*
     PathfindingComponent.h
     Purpose: Header file for the PathfindingComponent class, which is responsible for finding paths in a navigation grid using the A* algorithm.
-    The component finds the NavigationBuilder in the world, initializes pathfinding nodes, and provides a method to find a path between two points.
+    The component finds the NavigationBuilder in the world, shares the pathfinding graph the PathfindingSubsystem keeps for it, and provides a method to find a path between two points.
 */
 
 #pragma once
@@ -9,50 +9,87 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "NavigationBuilder.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+#include "PathfindingKernels.h"
+#include "PathfindingPathCache.h"
+#include "PathfindingFlowField.h"
+#include "PathfindingDStarLite.h"
+#include "PathfindingPath.h"
+#include "UObject/ObjectKey.h"
+#include <atomic>
 #include "PathfindingComponent.generated.h"
 
-// Structure representing a node in the pathfinding grid
+// Search algorithm used by a pathfinding query
+UENUM(BlueprintType)
+enum class EPathfindingSearchMode : uint8
+{
+    // Plain A* over every neighbor
+    AStar,
+    // Jump Point Search over the precomputed jump distances. Same path cost as A*, far fewer expanded nodes on open surfaces
+    JumpPointSearch,
+    // A* from both ends at once. Same path cost as A*, fewer expanded nodes on long queries and early failure for walled-off ends
+    Bidirectional,
+    // HPA* over the cluster entrances, refined cluster by cluster. Near-optimal paths, scales to very large grids
+    Hierarchical,
+    // D* Lite kept by the component between queries to the same goal. Replanning after nodes are blocked or freed only repairs
+    // what the change affects. Asynchronous and batched queries have no state to keep and search with plain A*
+    Incremental
+};
+
+// Priority class of an asynchronous path request. Higher classes are picked up first by the worker pool
+UENUM(BlueprintType)
+enum class EPathRequestPriority : uint8
+{
+    // Requests the player is waiting on, such as click-to-move
+    Player,
+    // Gameplay-relevant AI requests
+    Gameplay,
+    // Ambient AI that can tolerate a late answer
+    Ambient
+};
+
+// Handle to an asynchronous path request
 USTRUCT(BlueprintType)
-struct FPathfindingNode
+struct FPathRequestHandle
 {
     GENERATED_BODY()
 
-    // World location of the node
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    FVector Location;
+    // Identifier of the request, zero for an invalid handle
+    uint32 RequestId = 0;
 
-    // Unique identifier for the node
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    FIntPoint ID;
+    bool IsValid() const { return RequestId != 0; }
 
-    // Cost from the starting node to this node
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    int32 GCost;
+    bool operator==(const FPathRequestHandle& Other) const
+    {
+        return RequestId == Other.RequestId;
+    }
+};
 
-    // Heuristic estimate from this node to the end node
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    int32 HCost;
+// Start and goal locations of one query in a batch
+USTRUCT(BlueprintType)
+struct FPathQuery
+{
+    GENERATED_BODY()
 
-    // Sum of GCost and HCost
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    int32 FCost;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PathQuery")
+    FVector StartLocation = FVector::ZeroVector;
 
-    // Index of the parent node in the pathfinding array
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    int32 ParentIndex;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PathQuery")
+    FVector EndLocation = FVector::ZeroVector;
+};
 
-    // Whether the node is traversable
-    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
-    bool bIsValid;
+// Called on the game thread when an asynchronous path request finishes. The path is empty if none was found
+// The handler may move the path out to keep it, otherwise its buffer goes back to the pool once the handler returns
+DECLARE_DELEGATE_TwoParams(FOnPathRequestComplete, FPathRequestHandle /*Handle*/, FPathfindingPath& /*Path*/);
 
-    // Default constructor
-    FPathfindingNode() : Location(FVector::ZeroVector), ID(FIntPoint(-1, -1)), GCost(0), HCost(0), FCost(0), ParentIndex(INDEX_NONE), bIsValid(true) {}
+// State of an asynchronous path request, shared between the game thread and the worker running it
+struct FPathRequestState
+{
+    FPathRequestHandle Handle;
 
-    // Equality operator for node comparison
-    bool operator==(const FPathfindingNode& Other) const
-    {
-        return ID == Other.ID;
-    }
+    // Set from the game thread, polled by the worker so a cancelled search stops early
+    std::atomic<bool> bCancelled{ false };
 };
 
 // Component class for pathfinding
@@ -65,29 +102,162 @@ public:
     // Constructor
     UPathfindingComponent();
 
+    // Number of ALT landmarks the A* heuristic uses
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+    int32 NumLandmarks = 8;
+
+    // Memory the landmark cost tables may take, in megabytes. Fewer landmarks are used if the grid is too large for NumLandmarks
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+    int32 LandmarkMemoryBudgetMB = 16;
+
+    // Reduce found paths to their corner waypoints by line-of-sight string pulling, so agents walk straight lines instead of every grid node
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+    bool bAnyAnglePaths = false;
+
+    // Search toward the closest node the start can reach when the goal lies in another connected component, instead of failing the query
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+    bool bRedirectUnreachableGoals = false;
+
+    // Connectivity, heuristic and cost policy of the AStar search mode. Each combination runs its own compiled kernel
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+    FPathfindingSearchPolicies SearchPolicies;
+
+    // Number of recent paths kept for repeated queries. Zero disables the cache
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+    int32 PathCacheCapacity = 128;
+
 protected:
     // Called when the game starts
     virtual void BeginPlay() override;
 
+    // Called when the component is removed from play, cancels pending requests
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
     // Initializes pathfinding nodes from the NavigationBuilder
     void InitializePathfinding();
 
-    // Finds a path between two locations using the A* algorithm
-    TArray<FPathfindingNode> FindPath(const FVector& StartLocation, const FVector& EndLocation);
+    // Finds a path between two locations using the given search algorithm
+    TArray<FPathfindingNode> FindPath(const FVector& StartLocation, const FVector& EndLocation, EPathfindingSearchMode SearchMode = EPathfindingSearchMode::AStar);
+
+    // Finds a path between two locations into a compact path backed by a pooled buffer. Returns false if no path exists
+    // Reusing OutPath across queries, or moving it on to whoever follows it, keeps queries free of heap allocations
+    bool FindPath(const FVector& StartLocation, const FVector& EndLocation, FPathfindingPath& OutPath, EPathfindingSearchMode SearchMode = EPathfindingSearchMode::AStar);
 
-    // Finds the closest pathfinding node to a given location
-    FPathfindingNode* GetClosestNode(const FVector& Location);
+    // Index of the closest pathfinding node to a given location, INDEX_NONE if pathfinding is not initialized or the graph has no valid node
+    // Node indices stay valid across edits, a cell that loses its node leaves an invalid slot behind
+    int32 GetClosestNodeIndex(const FVector& Location) const;
+
+    // Index of the closest pathfinding node to each location, INDEX_NONE where the graph has no valid node
+    void GetClosestNodeIndices(const TArray<FVector>& Locations, TArray<int32>& OutNodeIndices) const;
+
+    // USTRUCT view of a node, built from the graph on demand. A default node if the index is out of range
+    FPathfindingNode GetNode(int32 NodeIndex) const;
 
     // Calculates the shortest path between two nodes using the A* algorithm
-    TArray<FPathfindingNode> CalculateAStarPath(FPathfindingNode* StartNode, FPathfindingNode* EndNode);
+    TArray<FPathfindingNode> CalculateAStarPath(int32 StartIndex, int32 EndIndex);
+
+    // Calculates the shortest path using caller-owned scratch state. The graph is never written,
+    // so calls with distinct contexts do not interfere with each other
+    TArray<FPathfindingNode> CalculateAStarPath(int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context) const;
+
+    // Calculates the shortest path between two nodes using the given search algorithm
+    TArray<FPathfindingNode> CalculatePath(int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode);
+
+    // Calculates the shortest path using the given search algorithm and caller-owned scratch state
+    TArray<FPathfindingNode> CalculatePath(int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode, FPathfindingSearchContext& Context) const;
+
+    // Queues a path search on the worker pool and returns immediately. OnComplete runs on the game thread with the result
+    // A newer request from the same Requester supersedes its pending one, which is cancelled and never reported
+    FPathRequestHandle RequestPathAsync(const FVector& StartLocation, const FVector& EndLocation, FOnPathRequestComplete OnComplete,
+        EPathRequestPriority Priority = EPathRequestPriority::Gameplay, EPathfindingSearchMode SearchMode = EPathfindingSearchMode::AStar, const UObject* Requester = nullptr);
+
+    // Starts an A* search that the pathfinding subsystem spreads over frames within its global per-frame budget, and returns immediately
+    // OnComplete runs on the game thread once the search ends. Cancelling and superseding work as for RequestPathAsync
+    FPathRequestHandle RequestPathTimeSliced(const FVector& StartLocation, const FVector& EndLocation, FOnPathRequestComplete OnComplete, const UObject* Requester = nullptr);
+
+    // Finds paths for many start/goal pairs at once and returns them in query order, empty where no path exists
+    // Closest nodes are resolved for every query first, then the searches are spread over MaxWorkers workers (all cores if zero),
+    // each worker with its own pooled scratch state
+    TArray<FPathfindingPath> FindPathsBatch(const TArray<FPathQuery>& Queries, EPathfindingSearchMode SearchMode = EPathfindingSearchMode::AStar, int32 MaxWorkers = 0) const;
+
+    // Runs the same batch of random queries with 1, 2, 4... workers up to the core count and logs the throughput of each run
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    void BenchmarkBatchPathfinding(int32 NumQueries = 256, EPathfindingSearchMode SearchMode = EPathfindingSearchMode::AStar) const;
+
+    // Flow field toward the node closest to GoalLocation, shared with every other agent heading there. Null if pathfinding is not initialized
+    // Follow it with GetNextNode from the agent's node, and acquire it again once its navigation version no longer matches the graph
+    TSharedPtr<const FPathfindingFlowField, ESPMode::ThreadSafe> AcquireFlowField(const FVector& GoalLocation) const;
+
+    // Cancels a pending request. Its completion delegate will not run
+    void CancelPathRequest(FPathRequestHandle Handle);
+
+    // Whether the request is still queued or running
+    bool IsPathRequestPending(FPathRequestHandle Handle) const { return PendingRequests.Contains(Handle.RequestId); }
+
+    // Hit, miss and memory counters of the path cache
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    FPathCacheStats GetPathCacheStats() const { return PathCache->GetStats(); }
+
+    // Shared, immutable graph the searches run against. Null until pathfinding is initialized
+    FPathfindingGraphPtr GetGraph() const { return GetSearchGraph(); }
 
 private:
+    // Runs the selected search algorithm between two node indices, answering from the path cache when it holds the path
+    // The AStar mode runs the kernel specialized for Policies, the other modes ignore them
+    static bool RunSearch(const FPathfindingGraph& SearchGraph, int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode, const FPathfindingSearchPolicies& Policies,
+        FPathfindingSearchContext& Context, TArray<int32>& OutPath, FPathfindingPathCache* Cache = nullptr);
+
+    // Picks up the graph the subsystem rebuilt after the NavigationBuilder edited or rebuilt its nodes. Searches already running keep the previous graph
+    void HandleGraphUpdated(const ANavigationBuilder* UpdatedBuilder, const TArray<FIntPoint>& ChangedIDs);
+
+    // Runs a search with the path cache into OutPath on the current graph. Not for the Incremental mode, which needs the component's state
+    bool SearchPath(int32 StartIndex, int32 EndIndex, EPathfindingSearchMode SearchMode, FPathfindingSearchContext& Context, FPathfindingPath& OutPath) const;
+
+    // Latest graph whose search tables are complete, from the subsystem. Right after an edit this is the graph before it until a worker
+    // has repaired the tables, so searches never wait for the repair. Game thread only
+    FPathfindingGraphPtr GetSearchGraph() const;
+
+    // Replans with the component's D* Lite state into OutPath, starting it over when the goal or the grid changed
+    bool SearchIncrementalPath(int32 StartIndex, int32 EndIndex, FPathfindingPath& OutPath);
+
+    // Goal a query searches for: EndIndex, or with bRedirect the closest node the start can reach if EndIndex is cut off from it
+    static int32 ResolveGoal(const FPathfindingGraph& SearchGraph, int32 StartIndex, int32 EndIndex, bool bRedirect);
+
+    // Keeps a found path, string-pulled to corner waypoints if bAnyAngle is set, and hands the buffer of a failed one back to the pool
+    static bool FinishPath(bool bFound, bool bAnyAngle, FPathfindingPath& Path);
+
+    // Registers a new pending request, cancelling the previous request of the same Requester
+    TSharedRef<FPathRequestState, ESPMode::ThreadSafe> CreatePathRequest(const UObject* Requester);
+
+    // Reports a finished asynchronous request on the game thread
+    void CompletePathRequest(const TSharedRef<FPathRequestState, ESPMode::ThreadSafe>& State, FPathfindingPath& Path, FOnPathRequestComplete OnComplete);
+
+    // Builder the graph comes from. Weak, since the builder can be destroyed before the component
+    TWeakObjectPtr<ANavigationBuilder> NavBuilder;
+
+    FDelegateHandle GraphUpdatedHandle;
+
+    // Node topology after the latest edit, shared through the subsystem with every component on the same NavigationBuilder
+    // Its search tables may lag behind the edit, the searches needing them run on GetSearchGraph
+    FPathfindingGraphPtr Graph;
+
+    // Scratch state reused by the queries issued through this component
+    FPathfindingSearchContext SearchContext;
+
+    // Search state of the Incremental mode, kept between queries to the same goal
+    FPathfindingDStarLite IncrementalSearch;
+
+    // Recent paths, shared with the workers running asynchronous and batched queries
+    TSharedRef<FPathfindingPathCache, ESPMode::ThreadSafe> PathCache;
+
+    // Asynchronous requests that have not completed yet, by request ID
+    TMap<uint32, TSharedRef<FPathRequestState, ESPMode::ThreadSafe>> PendingRequests;
 
-    ANavigationBuilder* NavBuilder;
+    // Latest request of each requester, so a newer request can supersede it
+    TMap<FObjectKey, uint32> LatestRequestByRequester;
 
-    // Array of pathfinding nodes used by the A* algorithm
-    TArray<FPathfindingNode> PathfindingNodes;
+    uint32 NextRequestId = 1;
 
 
 };
@@ -0,0 +1,230 @@
+/*
+    PathfindingDStarLite.cpp
+    Purpose: Implementation of the D* Lite incremental search.
+*/
+
+#include "PathfindingDStarLite.h"
+
+// Starts over toward a new goal on the given graph
+void FPathfindingDStarLite::Initialize(const FPathfindingGraphPtr& InGraph, int32 InStartIndex, int32 InGoalIndex)
+{
+    Graph = InGraph;
+    StartIndex = InStartIndex;
+    LastStartIndex = InStartIndex;
+    GoalIndex = InGoalIndex;
+    KeyOffset = 0;
+
+    const int32 NumNodes = Graph ? Graph->Num() : 0;
+    GCosts.Init(Infinity, NumNodes);
+    LookaheadCosts.Init(Infinity, NumNodes);
+    OpenSet.Initialize(NumNodes);
+
+    if (Graph && Graph->IsValidIndex(GoalIndex))
+    {
+        LookaheadCosts[GoalIndex] = 0;
+        int32 PrimaryKey, SecondaryKey;
+        CalculateKey(GoalIndex, PrimaryKey, SecondaryKey);
+        OpenSet.Push(GoalIndex, PrimaryKey, SecondaryKey);
+    }
+}
+
+// Moves the agent to another node
+void FPathfindingDStarLite::MoveStart(int32 NewStartIndex)
+{
+    if (NewStartIndex == StartIndex || !Graph || !Graph->IsValidIndex(NewStartIndex))
+    {
+        return;
+    }
+
+    // Every queued key was computed against the old start. The heuristic is consistent, so the distance moved bounds how far they are off
+    if (Graph->IsValidIndex(LastStartIndex))
+    {
+        KeyOffset += Graph->GetHeuristic(LastStartIndex, NewStartIndex);
+    }
+    LastStartIndex = NewStartIndex;
+    StartIndex = NewStartIndex;
+}
+
+// Switches to an edited graph and repairs the estimates around the nodes whose validity changed
+void FPathfindingDStarLite::UpdateGraph(const FPathfindingGraphPtr& NewGraph, const TArray<FIntPoint>& ChangedIDs)
+{
+    // A rebuilt grid may have different node indices, nothing carries over. Dirty rebuilds keep every node slot and only append
+    if (!Graph || !NewGraph || NewGraph->Num() < Graph->Num() || ChangedIDs.Num() == 0)
+    {
+        Initialize(NewGraph, StartIndex, GoalIndex);
+        return;
+    }
+
+    const FPathfindingGraphPtr PreviousGraph = Graph;
+    Graph = NewGraph;
+
+    // Appended nodes start with unknown costs, the changed cells below queue them
+    const int32 NumNodes = Graph->Num();
+    while (GCosts.Num() < NumNodes)
+    {
+        GCosts.Add(Infinity);
+        LookaheadCosts.Add(Infinity);
+    }
+    OpenSet.Grow(NumNodes);
+
+    for (const FIntPoint& ChangedID : ChangedIDs)
+    {
+        // A cell that lost its node keeps the retired slot, which only the previous lookup still points to
+        const int32 NodeIndex = Graph->NodeIndexLookup.Find(ChangedID);
+        UpdateNode(NodeIndex != INDEX_NONE ? NodeIndex : PreviousGraph->NodeIndexLookup.Find(ChangedID));
+        for (const FIntPoint& NeighborOffset : Graph->NeighborOffsets)
+        {
+            UpdateNode(Graph->NodeIndexLookup.Find(ChangedID + NeighborOffset));
+        }
+    }
+}
+
+// Brings the estimates up to date and writes the shortest path from the current start to the goal into OutPath
+bool FPathfindingDStarLite::Replan(TArray<int32>& OutPath)
+{
+    OutPath.Reset();
+    NumExpandedNodes = 0;
+
+    if (!Graph || !Graph->IsValidIndex(StartIndex) || !Graph->IsValidIndex(GoalIndex)
+        || !Graph->IsNodeValid(StartIndex) || !Graph->IsNodeValid(GoalIndex))
+    {
+        return false;
+    }
+
+    ComputeShortestPath();
+    if (GCosts[StartIndex] == Infinity)
+    {
+        return false;
+    }
+
+    // Walk down the cost-to-goal field, always to the neighbor that minimizes step cost plus remaining cost
+    const int32 NumNodes = Graph->Num();
+    OutPath.Add(StartIndex);
+    for (int32 CurrentIndex = StartIndex; CurrentIndex != GoalIndex; )
+    {
+        const FIntPoint CurrentID = Graph->NodeIDs[CurrentIndex];
+        int32 NextIndex = INDEX_NONE;
+        int32 NextCost = Infinity;
+
+        for (uint32 Moves = Graph->NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+        {
+            const int32 Direction = FMath::CountTrailingZeros(Moves);
+            const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+            const int32 NeighborIndex = Graph->GetNeighbor(CurrentID, Direction);
+            if (GCosts[NeighborIndex] != Infinity)
+            {
+                const int32 Cost = FPathfindingGraph::GetMovementCost(NeighborOffset) + GCosts[NeighborIndex];
+                if (Cost < NextCost)
+                {
+                    NextIndex = NeighborIndex;
+                    NextCost = Cost;
+                }
+            }
+        }
+
+        // Consistent estimates always lead downhill to the goal. Bail out rather than loop if they ever do not
+        if (NextIndex == INDEX_NONE || OutPath.Num() > NumNodes)
+        {
+            OutPath.Reset();
+            return false;
+        }
+
+        OutPath.Add(NextIndex);
+        CurrentIndex = NextIndex;
+    }
+
+    return true;
+}
+
+// Queue key of a node
+void FPathfindingDStarLite::CalculateKey(int32 NodeIndex, int32& OutPrimary, int32& OutSecondary) const
+{
+    OutSecondary = FMath::Min(GCosts[NodeIndex], LookaheadCosts[NodeIndex]);
+    OutPrimary = OutSecondary == Infinity ? Infinity : OutSecondary + Graph->GetHeuristic(StartIndex, NodeIndex) + KeyOffset;
+}
+
+// Recomputes the one-step lookahead cost of a node and queues it if it is inconsistent
+void FPathfindingDStarLite::UpdateNode(int32 NodeIndex)
+{
+    if (NodeIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    if (NodeIndex != GoalIndex)
+    {
+        // Moves are symmetric, so the successors of a node are its neighbors. A blocked node has none
+        int32 LookaheadCost = Infinity;
+        if (Graph->IsNodeValid(NodeIndex))
+        {
+            const FIntPoint NodeID = Graph->NodeIDs[NodeIndex];
+            for (uint32 Moves = Graph->NeighborMasks[NodeIndex]; Moves != 0; Moves &= Moves - 1)
+            {
+                const int32 Direction = FMath::CountTrailingZeros(Moves);
+                const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+                const int32 NeighborIndex = Graph->GetNeighbor(NodeID, Direction);
+                if (GCosts[NeighborIndex] != Infinity)
+                {
+                    LookaheadCost = FMath::Min(LookaheadCost, FPathfindingGraph::GetMovementCost(NeighborOffset) + GCosts[NeighborIndex]);
+                }
+            }
+        }
+        LookaheadCosts[NodeIndex] = LookaheadCost;
+    }
+
+    if (GCosts[NodeIndex] != LookaheadCosts[NodeIndex])
+    {
+        int32 PrimaryKey, SecondaryKey;
+        CalculateKey(NodeIndex, PrimaryKey, SecondaryKey);
+        OpenSet.Push(NodeIndex, PrimaryKey, SecondaryKey);
+    }
+    else
+    {
+        OpenSet.Remove(NodeIndex);
+    }
+}
+
+// Expands inconsistent nodes until the start node's cost is final
+void FPathfindingDStarLite::ComputeShortestPath()
+{
+    int32 StartPrimaryKey, StartSecondaryKey;
+    CalculateKey(StartIndex, StartPrimaryKey, StartSecondaryKey);
+
+    while (!OpenSet.IsEmpty()
+        && (IsKeyLess(OpenSet.GetMinFCost(), OpenSet.GetMinHCost(), StartPrimaryKey, StartSecondaryKey) || LookaheadCosts[StartIndex] != GCosts[StartIndex]))
+    {
+        const int32 CurrentIndex = OpenSet.Top();
+        const int32 OldPrimaryKey = OpenSet.GetMinFCost();
+        const int32 OldSecondaryKey = OpenSet.GetMinHCost();
+
+        int32 PrimaryKey, SecondaryKey;
+        CalculateKey(CurrentIndex, PrimaryKey, SecondaryKey);
+
+        if (IsKeyLess(OldPrimaryKey, OldSecondaryKey, PrimaryKey, SecondaryKey))
+        {
+            // Queued before the agent moved, so the key is stale
+            OpenSet.Push(CurrentIndex, PrimaryKey, SecondaryKey);
+        }
+        else
+        {
+            OpenSet.Pop();
+            ++NumExpandedNodes;
+
+            const bool bCostDropped = GCosts[CurrentIndex] > LookaheadCosts[CurrentIndex];
+            GCosts[CurrentIndex] = bCostDropped ? LookaheadCosts[CurrentIndex] : Infinity;
+            if (!bCostDropped)
+            {
+                // Raised: the node itself has to find a new way to the goal, as well as its neighbors
+                UpdateNode(CurrentIndex);
+            }
+
+            const FIntPoint CurrentID = Graph->NodeIDs[CurrentIndex];
+            for (uint32 Moves = Graph->NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+            {
+                UpdateNode(Graph->GetNeighbor(CurrentID, FMath::CountTrailingZeros(Moves)));
+            }
+        }
+
+        CalculateKey(StartIndex, StartPrimaryKey, StartSecondaryKey);
+    }
+}
@@ -0,0 +1,88 @@
+/*
+    PathfindingDStarLite.h
+    Purpose: Header file for the D* Lite incremental search, used by agents that keep replanning toward the same goal while the grid changes.
+    The search runs backward from the goal and keeps its cost-to-goal estimates between queries. When nodes are blocked or freed,
+    only the nodes whose estimates those changes invalidate are expanded again, so a replan costs in proportion to the change, not the grid.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingGraph.h"
+#include "PathfindingOpenSet.h"
+
+// Incremental search state of one agent toward one goal
+class WALLCLIMBER_ANDRE_API FPathfindingDStarLite
+{
+public:
+    // Starts over toward a new goal on the given graph. Nothing is searched until the next Replan
+    void Initialize(const FPathfindingGraphPtr& InGraph, int32 StartIndex, int32 InGoalIndex);
+
+    // Whether the state belongs to this goal on this navigation. The search only reads the topology, so a copy of its graph whose
+    // jump table, clusters or landmarks were repaired since still counts as the same graph
+    bool IsInitializedFor(const FPathfindingGraphPtr& InGraph, int32 InGoalIndex) const
+    {
+        return Graph && InGraph && Graph->NavigationVersion == InGraph->NavigationVersion && GoalIndex == InGoalIndex;
+    }
+
+    // Moves the agent to another node. The stored estimates stay valid, only the key offset grows
+    void MoveStart(int32 NewStartIndex);
+
+    // Switches to an edited graph and repairs the estimates around the nodes whose validity changed
+    // Changed nodes affect their own moves and the diagonal moves passing between their neighbors, so those nodes are all re-evaluated
+    // Without changed IDs, or with fewer nodes than before, the graph counts as rebuilt and the search starts over
+    void UpdateGraph(const FPathfindingGraphPtr& NewGraph, const TArray<FIntPoint>& ChangedIDs);
+
+    // Brings the estimates up to date and writes the shortest path from the current start to the goal into OutPath
+    // Returns false if the goal cannot be reached
+    bool Replan(TArray<int32>& OutPath);
+
+    // Graph the estimates belong to
+    const FPathfindingGraphPtr& GetGraph() const { return Graph; }
+
+    int32 GetGoalIndex() const { return GoalIndex; }
+
+    // Nodes expanded by the last Replan
+    int32 GetNumExpandedNodes() const { return NumExpandedNodes; }
+
+private:
+    // Stand-in for an unknown cost
+    static constexpr int32 Infinity = MAX_int32;
+
+    // Queue key of a node: (min(g, rhs) + heuristic to the start + key offset, min(g, rhs))
+    void CalculateKey(int32 NodeIndex, int32& OutPrimary, int32& OutSecondary) const;
+
+    // Recomputes the one-step lookahead cost of a node and queues it if it is inconsistent
+    void UpdateNode(int32 NodeIndex);
+
+    // Expands inconsistent nodes until the start node's cost is final
+    void ComputeShortestPath();
+
+    // Whether a queue key orders before another
+    static bool IsKeyLess(int32 PrimaryA, int32 SecondaryA, int32 PrimaryB, int32 SecondaryB)
+    {
+        return PrimaryA < PrimaryB || (PrimaryA == PrimaryB && SecondaryA < SecondaryB);
+    }
+
+    FPathfindingGraphPtr Graph;
+
+    int32 StartIndex = INDEX_NONE;
+    int32 GoalIndex = INDEX_NONE;
+
+    // Start node the key offset was last advanced from
+    int32 LastStartIndex = INDEX_NONE;
+
+    // Heuristic distance the agent has moved since the search began, added to new keys instead of re-keying the queue
+    int32 KeyOffset = 0;
+
+    // Cost to the goal as of the node's last expansion
+    TArray<int32> GCosts;
+
+    // One-step lookahead cost to the goal. A node whose two costs differ is inconsistent and queued
+    TArray<int32> LookaheadCosts;
+
+    // Inconsistent nodes, with the key's two parts as FCost and HCost
+    FPathfindingOpenSet OpenSet;
+
+    int32 NumExpandedNodes = 0;
+};
@@ -0,0 +1,88 @@
+/*
+    PathfindingFlowField.cpp
+    Purpose: Implementation of flow fields.
+*/
+
+#include "PathfindingFlowField.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+
+// Fills the field with one Dijkstra pass from the goal
+void FPathfindingFlowField::Build(const FPathfindingGraph& Graph, int32 InGoalIndex)
+{
+    NavigationVersion = Graph.NavigationVersion;
+    Directions.Init(NoDirection, Graph.Num());
+
+    // Nothing reaches a goal that is not walkable
+    GoalIndex = Graph.IsValidIndex(InGoalIndex) && Graph.IsNodeValid(InGoalIndex) ? InGoalIndex : INDEX_NONE;
+    if (GoalIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    FScopedPathfindingSearchContext Context;
+    Context->BeginQuery(Graph.Num());
+    FPathfindingOpenSet& OpenSet = Context->GetOpenSet();
+    Context->SetNode(GoalIndex, 0, INDEX_NONE);
+    OpenSet.Push(GoalIndex, 0, 0);
+
+    while (!OpenSet.IsEmpty())
+    {
+        const int32 CurrentIndex = OpenSet.Pop();
+        Context->Close(CurrentIndex);
+
+        // Settled, so the step back toward its parent is final
+        const int32 ParentIndex = Context->GetParent(CurrentIndex);
+        if (ParentIndex != INDEX_NONE)
+        {
+            Directions[CurrentIndex] = static_cast<uint8>(FPathfindingJumpTable::GetDirectionIndex(Graph.NodeIDs[ParentIndex] - Graph.NodeIDs[CurrentIndex]));
+        }
+
+        const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+        const int32 CurrentGCost = Context->GetGCost(CurrentIndex);
+
+        for (uint32 Moves = Graph.NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+        {
+            const int32 Direction = FMath::CountTrailingZeros(Moves);
+            const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+            const int32 NeighborIndex = Graph.GetNeighbor(CurrentID, Direction);
+            if (Context->IsClosed(NeighborIndex))
+            {
+                continue;
+            }
+
+            const int32 TentativeGScore = CurrentGCost + FPathfindingGraph::GetMovementCost(NeighborOffset);
+            if (TentativeGScore < Context->GetGCost(NeighborIndex))
+            {
+                Context->SetNode(NeighborIndex, TentativeGScore, CurrentIndex);
+                OpenSet.Push(NeighborIndex, TentativeGScore, 0);
+            }
+        }
+    }
+}
+
+// Index of the next node toward the goal, INDEX_NONE on the goal itself or if the goal cannot be reached
+int32 FPathfindingFlowField::GetNextNode(const FPathfindingGraph& Graph, int32 NodeIndex) const
+{
+    if (!Directions.IsValidIndex(NodeIndex) || Directions[NodeIndex] == NoDirection)
+    {
+        return INDEX_NONE;
+    }
+    return Graph.NodeIndexLookup.Find(Graph.NodeIDs[NodeIndex] + FPathfindingJumpTable::Directions[Directions[NodeIndex]]);
+}
+
+// Follows the field from a node and writes every node index up to the goal into OutPath
+bool FPathfindingFlowField::BuildPath(const FPathfindingGraph& Graph, int32 StartIndex, TArray<int32>& OutPath) const
+{
+    OutPath.Reset();
+    if (!CanReachGoal(StartIndex))
+    {
+        return false;
+    }
+
+    for (int32 NodeIndex = StartIndex; NodeIndex != INDEX_NONE; NodeIndex = GetNextNode(Graph, NodeIndex))
+    {
+        OutPath.Add(NodeIndex);
+    }
+    return true;
+}
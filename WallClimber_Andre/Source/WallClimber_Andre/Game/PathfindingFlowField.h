@@ -0,0 +1,51 @@
+/*
+    PathfindingFlowField.h
+    Purpose: Header file for flow fields, the next-step direction of every node toward a single goal.
+    One reverse Dijkstra pass from the goal fills the field, after which any number of agents heading to that goal
+    can follow it in O(1) per step instead of each running its own search.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPathfindingGraph;
+
+// Direction of the next step toward a goal for every node of a graph
+struct WALLCLIMBER_ANDRE_API FPathfindingFlowField
+{
+public:
+    // Stored for the goal itself and for nodes that cannot reach it
+    static constexpr uint8 NoDirection = MAX_uint8;
+
+    // Fills the field with one Dijkstra pass from the goal. Moves are symmetric, so the parent of each node is its next step
+    void Build(const FPathfindingGraph& Graph, int32 InGoalIndex);
+
+    // Goal node of the field, INDEX_NONE if the goal was not walkable
+    int32 GetGoalIndex() const { return GoalIndex; }
+
+    // Navigation version of the graph the field was built on
+    uint32 GetNavigationVersion() const { return NavigationVersion; }
+
+    // Whether an agent on the node can reach the goal
+    bool CanReachGoal(int32 NodeIndex) const
+    {
+        return (NodeIndex == GoalIndex && GoalIndex != INDEX_NONE) || (Directions.IsValidIndex(NodeIndex) && Directions[NodeIndex] != NoDirection);
+    }
+
+    // Index of the next node toward the goal, INDEX_NONE on the goal itself or if the goal cannot be reached
+    int32 GetNextNode(const FPathfindingGraph& Graph, int32 NodeIndex) const;
+
+    // Follows the field from a node and writes every node index up to the goal into OutPath. Returns false if the goal cannot be reached
+    bool BuildPath(const FPathfindingGraph& Graph, int32 StartIndex, TArray<int32>& OutPath) const;
+
+    // Memory held by the field, in bytes
+    int64 GetAllocatedSize() const { return Directions.GetAllocatedSize(); }
+
+private:
+    int32 GoalIndex = INDEX_NONE;
+    uint32 NavigationVersion = 0;
+
+    // One entry of FPathfindingJumpTable::Directions per node, NoDirection where there is no next step
+    TArray<uint8> Directions;
+};
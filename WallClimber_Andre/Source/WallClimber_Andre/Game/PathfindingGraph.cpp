@@ -0,0 +1,548 @@
+/*
+    PathfindingGraph.cpp
+    Purpose: Implementation of the pathfinding graph. Converts the NavigationBuilder output into the immutable topology used by the searches.
+*/
+
+#include "PathfindingGraph.h"
+
+// Builds a graph from the NavigationBuilder's current navigation nodes
+TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> FPathfindingGraph::Build(ANavigationBuilder& NavBuilder, int32 MaxLandmarks, int64 LandmarkBudgetBytes)
+{
+    TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> Graph = MakeShared<FPathfindingGraph, ESPMode::ThreadSafe>();
+
+    // Nodes mirror the builder's node order, so its ID lookup applies as is
+    Graph->NodeIndexLookup = NavBuilder.GetGridIndex();
+
+    // Split FNavigationNode into the graph's node arrays
+    const TArray<FNavigationNode>& NavNodes = NavBuilder.GetNavigationNodes();
+    for (const FNavigationNode& Node : NavNodes)
+    {
+        Graph->AddNode(Node.Location, Node.ID, Node.bIsValid);
+    }
+
+    Graph->GridLayout = NavBuilder.GetGridLayout();
+    Graph->ComponentLabels = NavBuilder.GetComponentLabels();
+    Graph->BuildSearchTables(MaxLandmarks, LandmarkBudgetBytes);
+    Graph->NavigationVersion = NavBuilder.GetNavigationVersion();
+
+    return Graph;
+}
+
+// Builds every table the searches read from the nodes, the ID lookup and the grid layout
+void FPathfindingGraph::BuildSearchTables(int32 MaxLandmarks, int64 LandmarkBudgetBytes)
+{
+    BuildNearestValidNodes();
+
+    // GetCircularNeighbors(1) only yields the four cross offsets, the grid is searched 8-connected with the 10/14 costs
+    NeighborOffsets.Append(FPathfindingJumpTable::Directions, UE_ARRAY_COUNT(FPathfindingJumpTable::Directions));
+    BuildNeighborMasks();
+    JumpTable.Build(*this);
+    Hierarchy.Build(*this);
+
+    TSharedRef<FPathfindingLandmarks, ESPMode::ThreadSafe> NewLandmarks = MakeShared<FPathfindingLandmarks, ESPMode::ThreadSafe>();
+    NewLandmarks->Build(*this, MaxLandmarks, LandmarkBudgetBytes);
+    if (NewLandmarks->Num() > 0)
+    {
+        Landmarks = NewLandmarks;
+    }
+}
+
+// Builds a copy of Previous with the changed cells refreshed from the NavigationBuilder
+TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> FPathfindingGraph::Update(const FPathfindingGraph& Previous, const ANavigationBuilder& NavBuilder, const TArray<FIntPoint>& ChangedIDs,
+    bool bDeferSearchTables)
+{
+    // Only the page pointers are copied, every write below clones the page it lands in
+    TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> Graph = MakeShared<FPathfindingGraph, ESPMode::ThreadSafe>(Previous);
+    Graph->NodeIndexLookup = NavBuilder.GetGridIndex();
+
+    // Nodes the builder appended for cells that gained one. They start invalid and take their validity from the changed cells below
+    const TArray<FNavigationNode>& NavNodes = NavBuilder.GetNavigationNodes();
+    for (int32 NodeIndex = Graph->Num(); NodeIndex < NavNodes.Num(); ++NodeIndex)
+    {
+        Graph->AddNode(NavNodes[NodeIndex].Location, NavNodes[NodeIndex].ID, false);
+    }
+
+    TArray<int32> FreedNodes;
+    for (const FIntPoint& ID : ChangedIDs)
+    {
+        const int32 NodeIndex = Graph->NodeIndexLookup.Find(ID);
+        if (NodeIndex != INDEX_NONE && NavNodes.IsValidIndex(NodeIndex))
+        {
+            if (NavNodes[NodeIndex].bIsValid && !Graph->IsNodeValid(NodeIndex))
+            {
+                FreedNodes.Add(NodeIndex);
+            }
+            Graph->SetNodeValidity(NodeIndex, NavNodes[NodeIndex].bIsValid);
+
+            // A re-traced node can also have moved
+            Graph->NodeLocations.GetMutable(NodeIndex) = NavNodes[NodeIndex].Location;
+        }
+        else if (Previous.NodeIndexLookup.Find(ID) != INDEX_NONE)
+        {
+            // The cell lost its node. The slot stays behind, invalid and with no moves out, so no other node index shifts
+            const int32 RetiredIndex = Previous.NodeIndexLookup.Find(ID);
+            Graph->SetNodeValidity(RetiredIndex, false);
+            Graph->NeighborMasks.GetMutable(RetiredIndex) = 0;
+        }
+    }
+    Graph->UpdateNeighborMasks(ChangedIDs);
+    Graph->ComponentLabels = NavBuilder.GetComponentLabels();
+    Graph->UpdateNearestValidNodes(ChangedIDs);
+    Graph->NavigationVersion = NavBuilder.GetNavigationVersion();
+
+    // Edits pile up until the search tables catch up with all of them at once
+    Graph->PendingChangedIDs.Append(ChangedIDs);
+    Graph->PendingFreedNodes.Append(FreedNodes);
+    if (!bDeferSearchTables)
+    {
+        Graph->RepairSearchTables();
+    }
+
+    return Graph;
+}
+
+// Builds a copy of Previous with the search tables an earlier deferred Update left behind brought up to date
+TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> FPathfindingGraph::CompleteSearchTables(const FPathfindingGraph& Previous)
+{
+    TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> Graph = MakeShared<FPathfindingGraph, ESPMode::ThreadSafe>(Previous);
+    Graph->RepairSearchTables();
+    return Graph;
+}
+
+// Repairs the jump table, the clusters and the landmark costs around the pending changed cells
+void FPathfindingGraph::RepairSearchTables()
+{
+    if (!HasPendingSearchTables())
+    {
+        return;
+    }
+
+    JumpTable.Repair(*this, PendingChangedIDs);
+    Hierarchy.Update(*this, PendingChangedIDs);
+
+    // A freed node can open shortcuts that make the stored landmark costs overestimate. Only the costs it lowers are repaired
+    if (Landmarks && (PendingFreedNodes.Num() > 0 || !Landmarks->IsBuiltFor(Num())))
+    {
+        TSharedRef<FPathfindingLandmarks, ESPMode::ThreadSafe> RepairedLandmarks = MakeShared<FPathfindingLandmarks, ESPMode::ThreadSafe>(*Landmarks);
+        RepairedLandmarks->Repair(*this, PendingFreedNodes);
+        Landmarks = RepairedLandmarks;
+    }
+
+    PendingChangedIDs.Reset();
+    PendingFreedNodes.Reset();
+}
+
+// Appends a node to every node array and returns its index
+int32 FPathfindingGraph::AddNode(const FVector& Location, const FIntPoint& ID, bool bIsValid)
+{
+    if (ValidCells.SizeX != NodeIndexLookup.SizeX || ValidCells.SizeY != NodeIndexLookup.SizeY)
+    {
+        ValidCells.Initialize(NodeIndexLookup.SizeX, NodeIndexLookup.SizeY);
+    }
+    ValidCells.Set(ID, bIsValid);
+
+    NeighborMasks.Add(0);
+    NodeLocations.Add(Location);
+    return NodeIDs.Add(ID);
+}
+
+// Fills NeighborMasks for every node from the validity bits and NeighborOffsets
+void FPathfindingGraph::BuildNeighborMasks()
+{
+    NeighborMasks.Init(0, Num());
+    for (int32 NodeIndex = 0; NodeIndex < Num(); ++NodeIndex)
+    {
+        NeighborMasks.GetMutable(NodeIndex) = ComputeNeighborMask(NodeIDs[NodeIndex]);
+    }
+}
+
+// Moves out of a cell, tested neighbor by neighbor
+uint8 FPathfindingGraph::ComputeNeighborMask(const FIntPoint& ID) const
+{
+    uint8 Mask = 0;
+    for (const FIntPoint& Offset : NeighborOffsets)
+    {
+        if (FindNeighbor(ID, Offset) != INDEX_NONE)
+        {
+            Mask |= 1 << FPathfindingJumpTable::GetDirectionIndex(Offset);
+        }
+    }
+    return Mask;
+}
+
+// Refreshes the neighbor masks a change to the given cells can affect
+void FPathfindingGraph::UpdateNeighborMasks(const TArray<FIntPoint>& ChangedIDs)
+{
+    for (const FIntPoint& ChangedID : ChangedIDs)
+    {
+        // A cell only takes part in the moves of the cells around it: as their target, or as a corner their diagonal moves pass
+        for (int32 X = ChangedID.X - 1; X <= ChangedID.X + 1; ++X)
+        {
+            for (int32 Y = ChangedID.Y - 1; Y <= ChangedID.Y + 1; ++Y)
+            {
+                const int32 NodeIndex = NodeIndexLookup.Find(FIntPoint(X, Y));
+                if (NodeIndex != INDEX_NONE)
+                {
+                    NeighborMasks.GetMutable(NodeIndex) = ComputeNeighborMask(NodeIDs[NodeIndex]);
+                }
+            }
+        }
+    }
+}
+
+// USTRUCT view of a node, built from the node arrays on demand
+FPathfindingNode FPathfindingGraph::GetNode(int32 NodeIndex) const
+{
+    FPathfindingNode Node;
+    Node.Location = NodeLocations[NodeIndex];
+    Node.ID = NodeIDs[NodeIndex];
+    Node.bIsValid = IsNodeValid(NodeIndex);
+    return Node;
+}
+
+// Node closest on the grid to Center among those Accept lets through, scanning square rings outward from FirstRadius
+template <typename AcceptType>
+int32 FPathfindingGraph::FindClosestNodeOnRings(const FIntPoint& Center, int32 FirstRadius, AcceptType Accept) const
+{
+    const int32 MaxRadius = FMath::Max(NodeIndexLookup.SizeX, NodeIndexLookup.SizeY);
+
+    int32 ClosestIndex = INDEX_NONE;
+    int32 ClosestDistanceSquared = MAX_int32;
+
+    auto Consider = [this, Center, &Accept, &ClosestIndex, &ClosestDistanceSquared](int32 X, int32 Y)
+    {
+        const int32 NodeIndex = NodeIndexLookup.Find(FIntPoint(X, Y));
+        const int32 DistanceSquared = (X - Center.X) * (X - Center.X) + (Y - Center.Y) * (Y - Center.Y);
+        if (NodeIndex != INDEX_NONE && DistanceSquared < ClosestDistanceSquared && Accept(NodeIndex))
+        {
+            ClosestIndex = NodeIndex;
+            ClosestDistanceSquared = DistanceSquared;
+        }
+    };
+
+    // Every cell on ring R is at least R away, so once R passes the closest distance found no later ring can beat it
+    for (int32 Radius = FMath::Max(FirstRadius, 1); Radius <= MaxRadius && Radius * Radius < ClosestDistanceSquared; ++Radius)
+    {
+        for (int32 Offset = -Radius; Offset <= Radius; ++Offset)
+        {
+            Consider(Center.X + Offset, Center.Y - Radius);
+            Consider(Center.X + Offset, Center.Y + Radius);
+        }
+        for (int32 Offset = -Radius + 1; Offset < Radius; ++Offset)
+        {
+            Consider(Center.X - Radius, Center.Y + Offset);
+            Consider(Center.X + Radius, Center.Y + Offset);
+        }
+    }
+
+    return ClosestIndex;
+}
+
+// Nearest valid node of the grid cell, from the nearest-valid-node map or by a ring scan beyond it
+int32 FPathfindingGraph::FindClosestNodeOfCell(const FIntPoint& ID) const
+{
+    const FIntPoint Cell(FMath::Clamp(ID.X, 0, NodeIndexLookup.SizeX - 1), FMath::Clamp(ID.Y, 0, NodeIndexLookup.SizeY - 1));
+    const int32 NodeIndex = NearestValidNodes[Cell.X * NodeIndexLookup.SizeY + Cell.Y];
+    if (NodeIndex != INDEX_NONE)
+    {
+        return NodeIndex;
+    }
+
+    // The map reaches every cell within a chamfer distance of 10 * SnapRadius, which takes in every ring up to 10 * SnapRadius / 14
+    return FindClosestNodeOnRings(Cell, 10 * SnapRadius / 14, [this](int32 CandidateIndex) { return IsNodeValid(CandidateIndex); });
+}
+
+// Index of the valid node closest to a world location, INDEX_NONE only if the graph has no valid node
+int32 FPathfindingGraph::FindClosestNode(const FVector& Location) const
+{
+    if (NearestValidNodes.Num() == 0)
+    {
+        return INDEX_NONE;
+    }
+
+    return FindClosestNodeOfCell(GridLayout.WorldToGridID(Location));
+}
+
+// Node connected to FromIndex that lies closest on the grid to ToIndex
+int32 FPathfindingGraph::FindClosestConnectedNode(int32 FromIndex, int32 ToIndex) const
+{
+    if (AreConnected(FromIndex, ToIndex))
+    {
+        return ToIndex;
+    }
+    if (!IsValidIndex(FromIndex) || !IsValidIndex(ToIndex) || ComponentLabels.Find(FromIndex) == INDEX_NONE)
+    {
+        return INDEX_NONE;
+    }
+
+    const int32 Component = ComponentLabels.Find(FromIndex);
+    return FindClosestNodeOnRings(NodeIDs[ToIndex], 1, [this, Component](int32 CandidateIndex) { return ComponentLabels.Find(CandidateIndex) == Component; });
+}
+
+// FindClosestNode for many locations at once, with the world-to-grid transform inverted only once
+void FPathfindingGraph::FindClosestNodes(const TArray<FVector>& Locations, TArray<int32>& OutNodeIndices) const
+{
+    OutNodeIndices.SetNumUninitialized(Locations.Num());
+    if (NearestValidNodes.Num() == 0)
+    {
+        for (int32& NodeIndex : OutNodeIndices)
+        {
+            NodeIndex = INDEX_NONE;
+        }
+        return;
+    }
+
+    const FMatrix WorldToLocal = GridLayout.Transform.ToInverseMatrixWithScale();
+    for (int32 i = 0; i < Locations.Num(); ++i)
+    {
+        OutNodeIndices[i] = FindClosestNodeOfCell(GridLayout.LocalToGridID(WorldToLocal.TransformPosition(Locations[i])));
+    }
+}
+
+// Fills NearestValidNodes with a two-pass chamfer distance transform
+void FPathfindingGraph::BuildNearestValidNodes()
+{
+    NearestValidNodes.Init(INDEX_NONE, NodeIndexLookup.SizeX * NodeIndexLookup.SizeY);
+    ComputeNearestValidNodes(FIntRect(0, 0, NodeIndexLookup.SizeX, NodeIndexLookup.SizeY));
+}
+
+// Recomputes the nearest valid nodes of the cells within SnapRadius of the changed cells
+void FPathfindingGraph::UpdateNearestValidNodes(const TArray<FIntPoint>& ChangedIDs)
+{
+    if (NearestValidNodes.Num() != NodeIndexLookup.SizeX * NodeIndexLookup.SizeY)
+    {
+        BuildNearestValidNodes();
+        return;
+    }
+
+    // Changed cells are gathered into tiles of SnapRadius cells, so nearby changes share one transform
+    TSet<FIntPoint> DirtyTiles;
+    for (const FIntPoint& ID : ChangedIDs)
+    {
+        if (NodeIndexLookup.IsInside(ID))
+        {
+            DirtyTiles.Add(FIntPoint(ID.X / SnapRadius, ID.Y / SnapRadius));
+        }
+    }
+
+    const FIntRect Grid(0, 0, NodeIndexLookup.SizeX, NodeIndexLookup.SizeY);
+    for (const FIntPoint& Tile : DirtyTiles)
+    {
+        FIntRect Region(Tile.X * SnapRadius, Tile.Y * SnapRadius, (Tile.X + 1) * SnapRadius, (Tile.Y + 1) * SnapRadius);
+        Region.InflateRect(SnapRadius);
+        Region.Clip(Grid);
+        ComputeNearestValidNodes(Region);
+    }
+}
+
+// Chamfer transform over Region inflated by SnapRadius, written back to the cells of Region only
+// A chamfer distance up to 10 * SnapRadius is at most SnapRadius cells along either axis, and the cheapest path of that length stays in the
+// box between its ends. So every node a cell of Region may snap to, and the path to it, lies inside the inflated window
+void FPathfindingGraph::ComputeNearestValidNodes(const FIntRect& Region)
+{
+    FIntRect Window = Region;
+    Window.InflateRect(SnapRadius);
+    Window.Clip(FIntRect(0, 0, NodeIndexLookup.SizeX, NodeIndexLookup.SizeY));
+
+    const int32 WindowSizeX = Window.Max.X - Window.Min.X;
+    const int32 WindowSizeY = Window.Max.Y - Window.Min.Y;
+    if (WindowSizeX <= 0 || WindowSizeY <= 0)
+    {
+        return;
+    }
+
+    // Grid distance of every window cell to the nearest valid node found so far, and that node. Row-major over the window
+    TArray<int32> Distances;
+    TArray<int32> Nearest;
+    Distances.Init(MAX_int32, WindowSizeX * WindowSizeY);
+    Nearest.Init(INDEX_NONE, WindowSizeX * WindowSizeY);
+
+    for (int32 X = 0; X < WindowSizeX; ++X)
+    {
+        for (int32 Y = 0; Y < WindowSizeY; ++Y)
+        {
+            const int32 NodeIndex = FindValidNode(FIntPoint(Window.Min.X + X, Window.Min.Y + Y));
+            if (NodeIndex != INDEX_NONE)
+            {
+                Distances[X * WindowSizeY + Y] = 0;
+                Nearest[X * WindowSizeY + Y] = NodeIndex;
+            }
+        }
+    }
+
+    // Takes over the nearest node of the cell at (X, Y) if going through it is shorter
+    auto Propagate = [&Distances, &Nearest, WindowSizeX, WindowSizeY](int32 Cell, int32 X, int32 Y, int32 StepCost)
+    {
+        if (X < 0 || X >= WindowSizeX || Y < 0 || Y >= WindowSizeY)
+        {
+            return;
+        }
+
+        const int32 FromCell = X * WindowSizeY + Y;
+        if (Distances[FromCell] != MAX_int32 && Distances[FromCell] + StepCost < Distances[Cell])
+        {
+            Distances[Cell] = Distances[FromCell] + StepCost;
+            Nearest[Cell] = Nearest[FromCell];
+        }
+    };
+
+    // The forward pass pulls distances from the neighbors already visited in row-major order, the backward pass from the remaining ones
+    for (int32 X = 0; X < WindowSizeX; ++X)
+    {
+        for (int32 Y = 0; Y < WindowSizeY; ++Y)
+        {
+            const int32 Cell = X * WindowSizeY + Y;
+            Propagate(Cell, X - 1, Y - 1, 14);
+            Propagate(Cell, X - 1, Y, 10);
+            Propagate(Cell, X - 1, Y + 1, 14);
+            Propagate(Cell, X, Y - 1, 10);
+        }
+    }
+    for (int32 X = WindowSizeX - 1; X >= 0; --X)
+    {
+        for (int32 Y = WindowSizeY - 1; Y >= 0; --Y)
+        {
+            const int32 Cell = X * WindowSizeY + Y;
+            Propagate(Cell, X + 1, Y + 1, 14);
+            Propagate(Cell, X + 1, Y, 10);
+            Propagate(Cell, X + 1, Y - 1, 14);
+            Propagate(Cell, X, Y + 1, 10);
+        }
+    }
+
+    for (int32 X = Region.Min.X; X < Region.Max.X; ++X)
+    {
+        for (int32 Y = Region.Min.Y; Y < Region.Max.Y; ++Y)
+        {
+            const int32 WindowCell = (X - Window.Min.X) * WindowSizeY + (Y - Window.Min.Y);
+            NearestValidNodes.GetMutable(X * NodeIndexLookup.SizeY + Y) = Distances[WindowCell] <= 10 * SnapRadius ? Nearest[WindowCell] : INDEX_NONE;
+        }
+    }
+}
+
+// Allocate a SizeX by SizeY grid with every bit cleared
+void FPathfindingCellBits::Initialize(int32 InSizeX, int32 InSizeY)
+{
+    SizeX = FMath::Max(InSizeX, 0);
+    SizeY = FMath::Max(InSizeY, 0);
+    WordsPerRow = (SizeY + 63) / 64;
+    Words.Init(0, SizeX * WordsPerRow);
+}
+
+// Whether every cell of row X from FromY to ToY, both included, is set
+bool FPathfindingCellBits::IsRowSpanSet(int32 X, int32 FromY, int32 ToY) const
+{
+    if (X < 0 || X >= SizeX || FromY < 0 || ToY >= SizeY || FromY > ToY)
+    {
+        return false;
+    }
+
+    const int32 RowStart = X * WordsPerRow;
+    const int32 FirstWord = FromY >> 6;
+    const int32 LastWord = ToY >> 6;
+    for (int32 WordIndex = FirstWord; WordIndex <= LastWord; ++WordIndex)
+    {
+        // Bits of the span within this word
+        uint64 SpanBits = ~uint64(0);
+        if (WordIndex == FirstWord)
+        {
+            SpanBits &= ~uint64(0) << (FromY & 63);
+        }
+        if (WordIndex == LastWord)
+        {
+            SpanBits &= ~uint64(0) >> (63 - (ToY & 63));
+        }
+
+        if ((Words[RowStart + WordIndex] & SpanBits) != SpanBits)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether the straight line between the centers of two nodes only crosses valid nodes
+bool FPathfindingGraph::HasLineOfSight(int32 FromIndex, int32 ToIndex) const
+{
+    const FIntPoint From = NodeIDs[FromIndex];
+    const FIntPoint To = NodeIDs[ToIndex];
+
+    const int32 StepX = To.X > From.X ? 1 : -1;
+    const int32 StepY = To.Y > From.Y ? 1 : -1;
+    const int32 DeltaX = FMath::Abs(To.X - From.X);
+    const int32 DeltaY = FMath::Abs(To.Y - From.Y);
+
+    // Along a row the cells are consecutive bits
+    if (DeltaX == 0)
+    {
+        return ValidCells.IsRowSpanSet(From.X, FMath::Min(From.Y, To.Y), FMath::Max(From.Y, To.Y));
+    }
+
+    // Walks every cell the line touches. Error tells which cell border the line crosses next: vertical if positive,
+    // horizontal if negative, and the corner itself if zero
+    FIntPoint Cell = From;
+    int32 Error = DeltaX - DeltaY;
+    for (int32 Remaining = DeltaX + DeltaY; Remaining > 0; --Remaining)
+    {
+        if (Error > 0)
+        {
+            Cell.X += StepX;
+            Error -= 2 * DeltaY;
+        }
+        else if (Error < 0)
+        {
+            Cell.Y += StepY;
+            Error += 2 * DeltaX;
+        }
+        else
+        {
+            if (!ValidCells.IsSet(FIntPoint(Cell.X + StepX, Cell.Y)) || !ValidCells.IsSet(FIntPoint(Cell.X, Cell.Y + StepY)))
+            {
+                return false;
+            }
+            Cell += FIntPoint(StepX, StepY);
+            Error += 2 * (DeltaX - DeltaY);
+            --Remaining;
+        }
+
+        if (!ValidCells.IsSet(Cell))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Turns a list of node indices into path nodes, with GCost accumulated along the path and HCost measured to the last node
+TArray<FPathfindingNode> FPathfindingGraph::MakePath(const TArray<int32>& NodeIndices) const
+{
+    TArray<FPathfindingNode> Path;
+    if (NodeIndices.Num() == 0)
+    {
+        return Path;
+    }
+
+    const int32 EndIndex = NodeIndices.Last();
+    Path.Reserve(NodeIndices.Num());
+
+    int32 GCost = 0;
+    for (int32 i = 0; i < NodeIndices.Num(); ++i)
+    {
+        FPathfindingNode& PathNode = Path.Add_GetRef(GetNode(NodeIndices[i]));
+        if (i > 0)
+        {
+            GCost += GetSegmentCost(PathNode.ID - NodeIDs[NodeIndices[i - 1]]);
+            PathNode.ParentIndex = NodeIndices[i - 1];
+        }
+        else
+        {
+            PathNode.ParentIndex = INDEX_NONE;
+        }
+        PathNode.GCost = GCost;
+        PathNode.HCost = GetHeuristic(NodeIndices[i], EndIndex);
+        PathNode.FCost = PathNode.GCost + PathNode.HCost;
+    }
+
+    return Path;
+}
@@ -0,0 +1,308 @@
+/*
+    PathfindingGraph.h
+    Purpose: Header file for the pathfinding graph, the node topology every search runs against.
+    The graph is built once from the NavigationBuilder and never modified afterwards, so any number of queries can share it,
+    back to back or in parallel, each with its own FPathfindingSearchContext.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationBuilder.h"
+#include "PathfindingJumpPoints.h"
+#include "PathfindingHierarchy.h"
+#include "PathfindingLandmarks.h"
+#include "PathfindingGraph.generated.h"
+
+// Structure representing a node in the pathfinding grid
+USTRUCT(BlueprintType)
+struct FPathfindingNode
+{
+    GENERATED_BODY()
+
+    // World location of the node
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    FVector Location;
+
+    // Unique identifier for the node
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    FIntPoint ID;
+
+    // Cost from the starting node to this node
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    int32 GCost;
+
+    // Heuristic estimate from this node to the end node
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    int32 HCost;
+
+    // Sum of GCost and HCost
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    int32 FCost;
+
+    // Index of the parent node in the pathfinding array
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    int32 ParentIndex;
+
+    // Whether the node is traversable
+    UPROPERTY(VisibleAnywhere, Category = "PathfindingNode")
+    bool bIsValid;
+
+    // Default constructor
+    FPathfindingNode() : Location(FVector::ZeroVector), ID(FIntPoint(-1, -1)), GCost(0), HCost(0), FCost(0), ParentIndex(INDEX_NONE), bIsValid(true) {}
+
+    // Equality operator for node comparison
+    bool operator==(const FPathfindingNode& Other) const
+    {
+        return ID == Other.ID;
+    }
+};
+
+// One bit per grid cell, set where the cell holds a valid node. Rows follow the row-major order of FNavigationGridIndex
+// and start on a fresh 64-bit word, so a run of cells along a row is tested a word at a time
+struct WALLCLIMBER_ANDRE_API FPathfindingCellBits
+{
+    int32 SizeX = 0;
+    int32 SizeY = 0;
+    int32 WordsPerRow = 0;
+    TNavigationPagedArray<uint64> Words;
+
+    // Allocate a SizeX by SizeY grid with every bit cleared
+    void Initialize(int32 InSizeX, int32 InSizeY);
+
+    bool IsSet(const FIntPoint& ID) const
+    {
+        return ID.X >= 0 && ID.X < SizeX && ID.Y >= 0 && ID.Y < SizeY
+            && (Words[ID.X * WordsPerRow + (ID.Y >> 6)] & (uint64(1) << (ID.Y & 63))) != 0;
+    }
+
+    void Set(const FIntPoint& ID, bool bValue)
+    {
+        uint64& Word = Words.GetMutable(ID.X * WordsPerRow + (ID.Y >> 6));
+        const uint64 Bit = uint64(1) << (ID.Y & 63);
+        Word = bValue ? (Word | Bit) : (Word & ~Bit);
+    }
+
+    // Whether every cell of row X from FromY to ToY, both included, is set
+    bool IsRowSpanSet(int32 X, int32 FromY, int32 ToY) const;
+};
+
+// Immutable node topology shared by every pathfinding query
+// Every per-node and per-cell table is a paged array, so a graph built by Update shares the pages an edit leaves alone with the graph before it
+struct WALLCLIMBER_ANDRE_API FPathfindingGraph
+{
+    // The nearest-valid-node map only holds valid nodes within this many cells, which bounds the cells an edit can reassign
+    static constexpr int32 SnapRadius = 32;
+
+    // Node data in one array per field, indexed by node index. The searches stream IDs and neighbor masks without pulling
+    // locations or the USTRUCT padding through the cache
+    TNavigationPagedArray<FIntPoint> NodeIDs;
+
+    // Moves out of every node, bit N set if the move by FPathfindingJumpTable::Directions[N] reaches a valid node without cutting a corner
+    // Expanding a node walks the set bits instead of testing each neighbor
+    TNavigationPagedArray<uint8> NeighborMasks;
+
+    // Validity of every grid cell, so validity tests need no node index
+    FPathfindingCellBits ValidCells;
+
+    // Only read when a path is handed out
+    TNavigationPagedArray<FVector> NodeLocations;
+
+    // Grid ID to node index lookup
+    FNavigationGridIndex NodeIndexLookup;
+
+    // Placement of the grid in the world, so a location quantizes straight to a grid ID
+    FNavigationGridLayout GridLayout;
+
+    // Connected component of every node, shared with the NavigationBuilder. Empty if the graph was not built from one
+    FNavigationComponentLabels ComponentLabels;
+
+    // Nearest valid node within SnapRadius of every grid cell, INDEX_NONE where there is none. Row-major like NodeIndexLookup
+    TNavigationPagedArray<int32> NearestValidNodes;
+
+    // Grid offsets of the neighbors each node connects to (8-connected)
+    TArray<FIntPoint> NeighborOffsets;
+
+    // Precomputed jump distances used by Jump Point Search
+    FPathfindingJumpTable JumpTable;
+
+    // HPA* clusters and entrances used by the hierarchical search
+    FPathfindingHierarchy Hierarchy;
+
+    // ALT cost tables, null if the memory budget leaves room for no landmark. Shared between graph versions while they stay valid
+    TSharedPtr<const FPathfindingLandmarks, ESPMode::ThreadSafe> Landmarks;
+
+    // Navigation version of the NavigationBuilder nodes the graph was built from
+    uint32 NavigationVersion = 0;
+
+    // Builds a graph from the NavigationBuilder's current navigation nodes, with up to MaxLandmarks landmarks within LandmarkBudgetBytes
+    static TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> Build(ANavigationBuilder& NavBuilder, int32 MaxLandmarks = 8, int64 LandmarkBudgetBytes = 16 * 1024 * 1024);
+
+    // Builds a copy of Previous with the changed cells refreshed from the NavigationBuilder. Queries still holding Previous keep using it unchanged
+    // The copy shares every page the edit does not write to. Nodes the builder appended for cells that gained one are added, and cells that lost
+    // their node leave an invalid slot behind. Only the jump distances along the rows, columns and diagonals through the changed cells, the
+    // clusters around them and the nearest valid nodes within SnapRadius of them are recomputed
+    // Landmark costs only grow when nodes are blocked, so the old tables stay a valid lower bound and are shared. Freed nodes repair the costs they lower
+    // With bDeferSearchTables only the topology is refreshed: validity, moves, components and nearest valid nodes. The jump table, the clusters and
+    // the landmark costs are left as they were until CompleteSearchTables, so searches reading only the topology (D* Lite) skip their repair
+    static TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> Update(const FPathfindingGraph& Previous, const ANavigationBuilder& NavBuilder, const TArray<FIntPoint>& ChangedIDs,
+        bool bDeferSearchTables = false);
+
+    // Builds a copy of Previous with the search tables an earlier deferred Update left behind brought up to date, for every edit since in one repair
+    static TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> CompleteSearchTables(const FPathfindingGraph& Previous);
+
+    // Whether a deferred Update left the jump table, the clusters or the landmark costs behind the topology
+    // JPS, HPA* and the landmark heuristic must not run on the graph until CompleteSearchTables caught them up
+    bool HasPendingSearchTables() const { return PendingChangedIDs.Num() > 0; }
+
+    // Number of nodes in the graph
+    int32 Num() const { return NodeIDs.Num(); }
+
+    // Whether NodeIndex refers to a node of the graph
+    bool IsValidIndex(int32 NodeIndex) const { return NodeIDs.IsValidIndex(NodeIndex); }
+
+    // Appends a node to every node array and returns its index. NodeIndexLookup must already cover the node's ID
+    int32 AddNode(const FVector& Location, const FIntPoint& ID, bool bIsValid);
+
+    // Builds every table the searches read from the nodes, the ID lookup and the grid layout. Build calls it once the nodes are added,
+    // graphs assembled node by node with AddNode call it themselves
+    void BuildSearchTables(int32 MaxLandmarks, int64 LandmarkBudgetBytes);
+
+    // Changes whether a node is traversable. The neighbor masks around it are left to UpdateNeighborMasks
+    void SetNodeValidity(int32 NodeIndex, bool bIsValid)
+    {
+        ValidCells.Set(NodeIDs[NodeIndex], bIsValid);
+    }
+
+    // Whether a node is traversable
+    bool IsNodeValid(int32 NodeIndex) const { return ValidCells.IsSet(NodeIDs[NodeIndex]); }
+
+    // Moves out of a cell, tested neighbor by neighbor. What NeighborMasks stores for the cell's node
+    uint8 ComputeNeighborMask(const FIntPoint& ID) const;
+
+    // Fills NeighborMasks for every node from the validity bits and NeighborOffsets
+    void BuildNeighborMasks();
+
+    // Refreshes the neighbor masks a change to the given cells can affect: their own and those of the 8 cells around each
+    void UpdateNeighborMasks(const TArray<FIntPoint>& ChangedIDs);
+
+    // Index of the node one move away in the given direction. Only for directions set in the node's neighbor mask, which guarantees the node exists
+    int32 GetNeighbor(const FIntPoint& ID, int32 Direction) const
+    {
+        const FIntPoint NeighborID = ID + FPathfindingJumpTable::Directions[Direction];
+        return NodeIndexLookup.NodeIndices[NeighborID.X * NodeIndexLookup.SizeY + NeighborID.Y];
+    }
+
+    // USTRUCT view of a node for Blueprint and editor inspection, built from the node arrays on demand. Never read by the searches
+    FPathfindingNode GetNode(int32 NodeIndex) const;
+
+    // Index of the valid node closest to a world location, INDEX_NONE only if the graph has no valid node
+    // The location is quantized to its grid cell, which the nearest-valid-node map resolves in O(1) within SnapRadius. Cells farther from
+    // every valid node fall back to a ring scan. Distances are measured on the grid plane, so a location outside the grid resolves from the
+    // border cell nearest to it
+    int32 FindClosestNode(const FVector& Location) const;
+
+    // FindClosestNode for many locations at once, with the world-to-grid transform inverted only once
+    void FindClosestNodes(const TArray<FVector>& Locations, TArray<int32>& OutNodeIndices) const;
+
+    // Fills NearestValidNodes with a two-pass chamfer distance transform, the 10/14 step costs propagated across the grid
+    void BuildNearestValidNodes();
+
+    // Recomputes the nearest valid nodes of the cells within SnapRadius of the changed cells, the only ones a change there can reach
+    void UpdateNearestValidNodes(const TArray<FIntPoint>& ChangedIDs);
+
+    // Index of the valid node with the given grid ID, INDEX_NONE if there is none
+    int32 FindValidNode(const FIntPoint& ID) const
+    {
+        return ValidCells.IsSet(ID) ? NodeIndexLookup.Find(ID) : INDEX_NONE;
+    }
+
+    // Whether a path can join the two nodes. O(1), lets queries between disconnected nodes fail without a search
+    bool AreConnected(int32 FromIndex, int32 ToIndex) const
+    {
+        if (!IsValidIndex(FromIndex) || !IsValidIndex(ToIndex))
+        {
+            return false;
+        }
+        if (ComponentLabels.Num() == 0)
+        {
+            return true;
+        }
+        const int32 Component = ComponentLabels.Find(FromIndex);
+        return Component != INDEX_NONE && Component == ComponentLabels.Find(ToIndex);
+    }
+
+    // Node connected to FromIndex that lies closest on the grid to ToIndex, ToIndex itself when it is reachable. INDEX_NONE if FromIndex is not valid
+    // Searches rings of growing radius around ToIndex, so the cost grows with the distance to the reachable area, not with the grid
+    int32 FindClosestConnectedNode(int32 FromIndex, int32 ToIndex) const;
+
+    // Index of the valid node reached from ID by moving by Offset, INDEX_NONE if the move is blocked
+    // Diagonal moves may not cut corners, so both cross cells they pass between must be valid too
+    int32 FindNeighbor(const FIntPoint& ID, const FIntPoint& Offset) const
+    {
+        if (Offset.X != 0 && Offset.Y != 0
+            && (FindValidNode(FIntPoint(ID.X + Offset.X, ID.Y)) == INDEX_NONE || FindValidNode(FIntPoint(ID.X, ID.Y + Offset.Y)) == INDEX_NONE))
+        {
+            return INDEX_NONE;
+        }
+        return FindValidNode(ID + Offset);
+    }
+
+    // Cost of a single step by a neighbor offset. Cross shape cost is 10, diagonal (X shape) cost is 14
+    static int32 GetMovementCost(const FIntPoint& Offset)
+    {
+        return (FMath::Abs(Offset.X) + FMath::Abs(Offset.Y) == 1) ? 10 : 14;
+    }
+
+    // Cost of a straight move by any grid offset: the step cost between neighbors, 10 per cell of straight-line length otherwise
+    static int32 GetSegmentCost(const FIntPoint& Offset)
+    {
+        return (FMath::Abs(Offset.X) <= 1 && FMath::Abs(Offset.Y) <= 1) ? GetMovementCost(Offset) : FMath::RoundToInt(10.0 * FMath::Sqrt(static_cast<double>(Offset.X * Offset.X + Offset.Y * Offset.Y)));
+    }
+
+    // Whether the straight line between the centers of two nodes only crosses valid nodes
+    // Where the line passes exactly through a grid corner both cells beside it must be valid, the rule that keeps diagonal moves from cutting corners
+    bool HasLineOfSight(int32 FromIndex, int32 ToIndex) const;
+
+    // Octile distance between two nodes, the exact cost on open ground with the 10/14 step costs. Consistent, so every search can use it
+    int32 GetHeuristic(int32 FromIndex, int32 ToIndex) const
+    {
+        const FIntPoint Delta = NodeIDs[FromIndex] - NodeIDs[ToIndex];
+        const int32 DeltaX = FMath::Abs(Delta.X);
+        const int32 DeltaY = FMath::Abs(Delta.Y);
+        return 10 * FMath::Max(DeltaX, DeltaY) + 4 * FMath::Min(DeltaX, DeltaY);
+    }
+
+    // The larger of the octile distance and the landmark bound. Admissible, but rounding in the landmark tables can make it slightly
+    // inconsistent, so it is only used by searches that reopen nodes reached again at a lower cost
+    int32 GetLandmarkHeuristic(int32 FromIndex, int32 ToIndex) const
+    {
+        const int32 Octile = GetHeuristic(FromIndex, ToIndex);
+        return Landmarks ? FMath::Max(Octile, Landmarks->GetHeuristic(FromIndex, ToIndex)) : Octile;
+    }
+
+    // Turns a list of node indices into path nodes, with GCost accumulated along the path and HCost measured to the last node
+    // Consecutive nodes need not be neighbors, any-angle paths are costed by the straight-line length of their segments
+    TArray<FPathfindingNode> MakePath(const TArray<int32>& NodeIndices) const;
+
+private:
+    // Nearest valid node of the grid cell, from the nearest-valid-node map or by a ring scan where no valid node lies within SnapRadius
+    int32 FindClosestNodeOfCell(const FIntPoint& ID) const;
+
+    // Node closest on the grid to Center among those Accept lets through, scanning square rings outward from FirstRadius. INDEX_NONE if none does
+    template <typename AcceptType>
+    int32 FindClosestNodeOnRings(const FIntPoint& Center, int32 FirstRadius, AcceptType Accept) const;
+
+    // Chamfer transform over Region inflated by SnapRadius, written back to the cells of Region only
+    void ComputeNearestValidNodes(const FIntRect& Region);
+
+    // Repairs the jump table, the clusters and the landmark costs around the pending changed cells
+    void RepairSearchTables();
+
+    // Cells changed by deferred Updates since the search tables were last repaired, and the nodes those edits freed
+    TArray<FIntPoint> PendingChangedIDs;
+    TArray<int32> PendingFreedNodes;
+};
+
+// Shared handle to a graph. Graphs are never modified once built, so the handle can be passed to other threads
+typedef TSharedPtr<const FPathfindingGraph, ESPMode::ThreadSafe> FPathfindingGraphPtr;
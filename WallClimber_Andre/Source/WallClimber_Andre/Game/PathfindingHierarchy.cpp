@@ -0,0 +1,428 @@
+/*
+    PathfindingHierarchy.cpp
+    Purpose: Implementation of the HPA* cluster layer and of the hierarchical search over it.
+*/
+
+#include "PathfindingHierarchy.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // A* between two nodes (Dijkstra from the start if EndIndex is INDEX_NONE) that never leaves the Min..Max cell rectangle
+    // Costs of every node reached are left in the context
+    bool SearchInBounds(const FPathfindingGraph& Graph, const FIntPoint& Min, const FIntPoint& Max, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context)
+    {
+        Context.BeginQuery(Graph.Num());
+        FPathfindingOpenSet& OpenSet = Context.GetOpenSet();
+
+        const int32 StartHCost = EndIndex != INDEX_NONE ? Graph.GetHeuristic(StartIndex, EndIndex) : 0;
+        Context.SetNode(StartIndex, 0, INDEX_NONE);
+        OpenSet.Push(StartIndex, StartHCost, StartHCost);
+
+        while (!OpenSet.IsEmpty())
+        {
+            if (Context.IsCancelled())
+            {
+                return false;
+            }
+
+            const int32 CurrentIndex = OpenSet.Pop();
+            Context.Close(CurrentIndex);
+
+            if (CurrentIndex == EndIndex)
+            {
+                return true;
+            }
+
+            const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+            const int32 CurrentGCost = Context.GetGCost(CurrentIndex);
+
+            for (uint32 Moves = Graph.NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+            {
+                const int32 Direction = FMath::CountTrailingZeros(Moves);
+                const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+                const FIntPoint NeighborID = CurrentID + NeighborOffset;
+                if (NeighborID.X < Min.X || NeighborID.X > Max.X || NeighborID.Y < Min.Y || NeighborID.Y > Max.Y)
+                {
+                    continue;
+                }
+
+                const int32 NeighborIndex = Graph.GetNeighbor(CurrentID, Direction);
+                if (Context.IsClosed(NeighborIndex))
+                {
+                    continue;
+                }
+
+                const int32 TentativeGScore = CurrentGCost + FPathfindingGraph::GetMovementCost(NeighborOffset);
+                if (TentativeGScore >= Context.GetGCost(NeighborIndex))
+                {
+                    continue;
+                }
+
+                const int32 HCost = EndIndex != INDEX_NONE ? Graph.GetHeuristic(NeighborIndex, EndIndex) : 0;
+                Context.SetNode(NeighborIndex, TentativeGScore, CurrentIndex);
+                OpenSet.Push(NeighborIndex, TentativeGScore + HCost, HCost);
+            }
+        }
+
+        // A full Dijkstra flood always succeeds, a point to point search ran out of nodes
+        return EndIndex == INDEX_NONE;
+    }
+
+    // Adds an entrance node to a cluster, or a link to an entrance it already has
+    void AddEntrance(FPathfindingHierarchy::FCluster& Cluster, int32 NodeIndex, int32 LinkedNodeIndex)
+    {
+        for (FPathfindingHierarchy::FEntrance& Entrance : Cluster.Entrances)
+        {
+            if (Entrance.NodeIndex == NodeIndex)
+            {
+                Entrance.Links.AddUnique(LinkedNodeIndex);
+                return;
+            }
+        }
+
+        FPathfindingHierarchy::FEntrance& Entrance = Cluster.Entrances.AddDefaulted_GetRef();
+        Entrance.NodeIndex = NodeIndex;
+        Entrance.Links.Add(LinkedNodeIndex);
+    }
+
+    // Walks one border of a cluster, from First along Step for Length cells, and places entrances on every run of cells
+    // that are walkable on both sides. Both clusters of a border find the same runs, so their entrances always pair up
+    void ScanBorder(const FPathfindingGraph& Graph, FPathfindingHierarchy::FCluster& Cluster, const FIntPoint& First, const FIntPoint& Step, const FIntPoint& Across, int32 Length)
+    {
+        int32 RunStart = INDEX_NONE;
+        for (int32 i = 0; i <= Length; ++i)
+        {
+            const FIntPoint InnerID = First + Step * i;
+            const bool bOpen = i < Length && Graph.FindValidNode(InnerID) != INDEX_NONE && Graph.FindValidNode(InnerID + Across) != INDEX_NONE;
+
+            if (bOpen && RunStart == INDEX_NONE)
+            {
+                RunStart = i;
+            }
+            else if (!bOpen && RunStart != INDEX_NONE)
+            {
+                const int32 RunEnd = i - 1;
+                const int32 RunLength = RunEnd - RunStart + 1;
+
+                const int32 Positions[2] = { RunLength >= FPathfindingHierarchy::LongEntranceLength ? RunStart : (RunStart + RunEnd) / 2, RunEnd };
+                const int32 NumPositions = RunLength >= FPathfindingHierarchy::LongEntranceLength ? 2 : 1;
+                for (int32 p = 0; p < NumPositions; ++p)
+                {
+                    const FIntPoint EntranceID = First + Step * Positions[p];
+                    AddEntrance(Cluster, Graph.FindValidNode(EntranceID), Graph.FindValidNode(EntranceID + Across));
+                }
+
+                RunStart = INDEX_NONE;
+            }
+        }
+    }
+}
+
+// Entrance slot of a graph node, INDEX_NONE if the node is not an entrance of this cluster
+int32 FPathfindingHierarchy::FCluster::FindEntrance(int32 NodeIndex) const
+{
+    for (int32 i = 0; i < Entrances.Num(); ++i)
+    {
+        if (Entrances[i].NodeIndex == NodeIndex)
+        {
+            return i;
+        }
+    }
+    return INDEX_NONE;
+}
+
+// Computes the entrances and intra-cluster costs of every cluster of the graph
+void FPathfindingHierarchy::Build(const FPathfindingGraph& Graph)
+{
+    GridSizeX = Graph.NodeIndexLookup.SizeX;
+    GridSizeY = Graph.NodeIndexLookup.SizeY;
+    NumClustersX = FMath::DivideAndRoundUp(GridSizeX, ClusterSize);
+    NumClustersY = FMath::DivideAndRoundUp(GridSizeY, ClusterSize);
+
+    Clusters.Reset();
+    Clusters.SetNum(NumClustersX * NumClustersY);
+
+    // Clusters only read the graph and write their own entry
+    ParallelFor(Clusters.Num(), [this, &Graph](int32 ClusterIndex)
+    {
+        FScopedPathfindingSearchContext Context;
+        Clusters[ClusterIndex] = BuildCluster(Graph, ClusterIndex, *Context);
+    });
+}
+
+// Recomputes only the clusters affected by a validity change of the given grid IDs
+void FPathfindingHierarchy::Update(const FPathfindingGraph& Graph, const TArray<FIntPoint>& ChangedIDs)
+{
+    if (!IsBuiltFor(Graph))
+    {
+        Build(Graph);
+        return;
+    }
+
+    TArray<int32> DirtyClusters;
+    for (const FIntPoint& ID : ChangedIDs)
+    {
+        if (!Graph.NodeIndexLookup.IsInside(ID))
+        {
+            continue;
+        }
+
+        const int32 ClusterX = ID.X / ClusterSize;
+        const int32 ClusterY = ID.Y / ClusterSize;
+        DirtyClusters.AddUnique(ClusterX * NumClustersY + ClusterY);
+
+        // Cells on a border also shape the entrances of the cluster across it
+        if (ID.X % ClusterSize == 0 && ClusterX > 0)
+        {
+            DirtyClusters.AddUnique((ClusterX - 1) * NumClustersY + ClusterY);
+        }
+        if (ID.X % ClusterSize == ClusterSize - 1 && ClusterX + 1 < NumClustersX)
+        {
+            DirtyClusters.AddUnique((ClusterX + 1) * NumClustersY + ClusterY);
+        }
+        if (ID.Y % ClusterSize == 0 && ClusterY > 0)
+        {
+            DirtyClusters.AddUnique(ClusterX * NumClustersY + ClusterY - 1);
+        }
+        if (ID.Y % ClusterSize == ClusterSize - 1 && ClusterY + 1 < NumClustersY)
+        {
+            DirtyClusters.AddUnique(ClusterX * NumClustersY + ClusterY + 1);
+        }
+    }
+
+    ParallelFor(DirtyClusters.Num(), [this, &Graph, &DirtyClusters](int32 i)
+    {
+        FScopedPathfindingSearchContext Context;
+        Clusters[DirtyClusters[i]] = BuildCluster(Graph, DirtyClusters[i], *Context);
+    });
+}
+
+// Whether the layer has been computed for the graph's grid
+bool FPathfindingHierarchy::IsBuiltFor(const FPathfindingGraph& Graph) const
+{
+    return Clusters.Num() > 0 && GridSizeX == Graph.NodeIndexLookup.SizeX && GridSizeY == Graph.NodeIndexLookup.SizeY;
+}
+
+// Inclusive grid ID bounds of a cluster
+void FPathfindingHierarchy::GetClusterBounds(int32 ClusterIndex, FIntPoint& OutMin, FIntPoint& OutMax) const
+{
+    OutMin = FIntPoint((ClusterIndex / NumClustersY) * ClusterSize, (ClusterIndex % NumClustersY) * ClusterSize);
+    OutMax = FIntPoint(FMath::Min(OutMin.X + ClusterSize, GridSizeX) - 1, FMath::Min(OutMin.Y + ClusterSize, GridSizeY) - 1);
+}
+
+// Places the entrances of one cluster along its four borders and computes the costs between them
+TSharedRef<const FPathfindingHierarchy::FCluster, ESPMode::ThreadSafe> FPathfindingHierarchy::BuildCluster(const FPathfindingGraph& Graph, int32 ClusterIndex, FPathfindingSearchContext& Context) const
+{
+    TSharedRef<FCluster, ESPMode::ThreadSafe> NewCluster = MakeShared<FCluster, ESPMode::ThreadSafe>();
+    FCluster& Cluster = *NewCluster;
+
+    FIntPoint Min, Max;
+    GetClusterBounds(ClusterIndex, Min, Max);
+    const int32 Width = Max.X - Min.X + 1;
+    const int32 Height = Max.Y - Min.Y + 1;
+
+    if (Min.X > 0)
+    {
+        ScanBorder(Graph, Cluster, Min, FIntPoint(0, 1), FIntPoint(-1, 0), Height);
+    }
+    if (Max.X < GridSizeX - 1)
+    {
+        ScanBorder(Graph, Cluster, FIntPoint(Max.X, Min.Y), FIntPoint(0, 1), FIntPoint(1, 0), Height);
+    }
+    if (Min.Y > 0)
+    {
+        ScanBorder(Graph, Cluster, Min, FIntPoint(1, 0), FIntPoint(0, -1), Width);
+    }
+    if (Max.Y < GridSizeY - 1)
+    {
+        ScanBorder(Graph, Cluster, FIntPoint(Min.X, Max.Y), FIntPoint(1, 0), FIntPoint(0, 1), Width);
+    }
+
+    // One flood per entrance gives its cost to every other entrance
+    const int32 NumEntrances = Cluster.Entrances.Num();
+    Cluster.IntraCosts.Init(MAX_int32, NumEntrances * NumEntrances);
+    for (int32 From = 0; From < NumEntrances; ++From)
+    {
+        SearchInBounds(Graph, Min, Max, Cluster.Entrances[From].NodeIndex, INDEX_NONE, Context);
+        for (int32 To = 0; To < NumEntrances; ++To)
+        {
+            Cluster.IntraCosts[From * NumEntrances + To] = Context.GetGCost(Cluster.Entrances[To].NodeIndex);
+        }
+    }
+
+    return NewCluster;
+}
+
+namespace PathfindingSearch
+{
+    bool FindHierarchicalPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath)
+    {
+        OutPath.Reset();
+        if (!Graph.IsValidIndex(StartIndex) || !Graph.IsValidIndex(EndIndex))
+        {
+            return false;
+        }
+
+        const FPathfindingHierarchy& Hierarchy = Graph.Hierarchy;
+        if (!Hierarchy.IsBuiltFor(Graph))
+        {
+            return FindAStarPath(Graph, StartIndex, EndIndex, Context, OutPath);
+        }
+
+        const int32 StartCluster = Hierarchy.GetClusterIndex(Graph.NodeIDs[StartIndex]);
+        const int32 EndCluster = Hierarchy.GetClusterIndex(Graph.NodeIDs[EndIndex]);
+        FIntPoint Min, Max;
+
+        // Nodes sharing a cluster may be joined inside it. That path competes with the abstract routes that leave the cluster
+        int32 LocalCost = MAX_int32;
+        if (StartCluster == EndCluster)
+        {
+            Hierarchy.GetClusterBounds(StartCluster, Min, Max);
+            if (SearchInBounds(Graph, Min, Max, StartIndex, EndIndex, Context))
+            {
+                LocalCost = Context.GetGCost(EndIndex);
+            }
+        }
+
+        // Connect the start node to the entrances of its cluster
+        TArray<TPair<int32, int32>> StartEdges;
+        const FPathfindingHierarchy::FCluster& StartClusterData = Hierarchy.GetCluster(StartCluster);
+        Hierarchy.GetClusterBounds(StartCluster, Min, Max);
+        SearchInBounds(Graph, Min, Max, StartIndex, INDEX_NONE, Context);
+        for (const FPathfindingHierarchy::FEntrance& Entrance : StartClusterData.Entrances)
+        {
+            const int32 Cost = Context.GetGCost(Entrance.NodeIndex);
+            if (Cost != MAX_int32)
+            {
+                StartEdges.Emplace(Entrance.NodeIndex, Cost);
+            }
+        }
+
+        // And the entrances of the end cluster to the end node. Moves are symmetric, so a flood from the end node gives their costs
+        TArray<int32> EndCosts;
+        const FPathfindingHierarchy::FCluster& EndClusterData = Hierarchy.GetCluster(EndCluster);
+        Hierarchy.GetClusterBounds(EndCluster, Min, Max);
+        SearchInBounds(Graph, Min, Max, EndIndex, INDEX_NONE, Context);
+        for (const FPathfindingHierarchy::FEntrance& Entrance : EndClusterData.Entrances)
+        {
+            EndCosts.Add(Context.GetGCost(Entrance.NodeIndex));
+        }
+
+        if (Context.IsCancelled() || (StartEdges.Num() == 0 && LocalCost == MAX_int32))
+        {
+            return false;
+        }
+
+        // A* over the abstract graph. Its nodes are the start, the end and the entrances, keyed by their graph index
+        Context.BeginQuery(Graph.Num());
+        FPathfindingOpenSet& OpenSet = Context.GetOpenSet();
+        const int32 StartHCost = Graph.GetHeuristic(StartIndex, EndIndex);
+        Context.SetNode(StartIndex, 0, INDEX_NONE);
+        OpenSet.Push(StartIndex, StartHCost, StartHCost);
+
+        bool bFoundCorridor = false;
+        while (!OpenSet.IsEmpty())
+        {
+            if (Context.IsCancelled())
+            {
+                return false;
+            }
+
+            const int32 CurrentIndex = OpenSet.Pop();
+            Context.Close(CurrentIndex);
+
+            if (CurrentIndex == EndIndex)
+            {
+                bFoundCorridor = true;
+                break;
+            }
+
+            const int32 CurrentGCost = Context.GetGCost(CurrentIndex);
+            auto Relax = [&Graph, &Context, &OpenSet, CurrentIndex, CurrentGCost, EndIndex](int32 NextIndex, int32 StepCost)
+            {
+                const int32 TentativeGScore = CurrentGCost + StepCost;
+                if (Context.IsClosed(NextIndex) || TentativeGScore >= Context.GetGCost(NextIndex))
+                {
+                    return;
+                }
+                const int32 HCost = Graph.GetHeuristic(NextIndex, EndIndex);
+                Context.SetNode(NextIndex, TentativeGScore, CurrentIndex);
+                OpenSet.Push(NextIndex, TentativeGScore + HCost, HCost);
+            };
+
+            if (CurrentIndex == StartIndex)
+            {
+                for (const TPair<int32, int32>& Edge : StartEdges)
+                {
+                    Relax(Edge.Key, Edge.Value);
+                }
+                if (LocalCost != MAX_int32)
+                {
+                    Relax(EndIndex, LocalCost);
+                }
+            }
+
+            const int32 ClusterIndex = Hierarchy.GetClusterIndex(Graph.NodeIDs[CurrentIndex]);
+            const FPathfindingHierarchy::FCluster& Cluster = Hierarchy.GetCluster(ClusterIndex);
+            const int32 EntranceSlot = Cluster.FindEntrance(CurrentIndex);
+            if (EntranceSlot == INDEX_NONE)
+            {
+                continue;
+            }
+
+            for (int32 Other = 0; Other < Cluster.Entrances.Num(); ++Other)
+            {
+                const int32 IntraCost = Cluster.GetIntraCost(EntranceSlot, Other);
+                if (Other != EntranceSlot && IntraCost != MAX_int32)
+                {
+                    Relax(Cluster.Entrances[Other].NodeIndex, IntraCost);
+                }
+            }
+
+            for (const int32 LinkedIndex : Cluster.Entrances[EntranceSlot].Links)
+            {
+                Relax(LinkedIndex, FPathfindingGraph::GetMovementCost(Graph.NodeIDs[LinkedIndex] - Graph.NodeIDs[CurrentIndex]));
+            }
+
+            if (ClusterIndex == EndCluster && EndCosts[EntranceSlot] != MAX_int32)
+            {
+                Relax(EndIndex, EndCosts[EntranceSlot]);
+            }
+        }
+
+        if (!bFoundCorridor)
+        {
+            return false;
+        }
+
+        // Refine the corridor. Links are single grid steps, every other hop stays inside one cluster
+        TArray<int32> Corridor;
+        Context.BuildPath(EndIndex, Corridor);
+
+        TArray<int32> Segment;
+        OutPath.Add(Corridor[0]);
+        for (int32 i = 1; i < Corridor.Num(); ++i)
+        {
+            const int32 FromCluster = Hierarchy.GetClusterIndex(Graph.NodeIDs[Corridor[i - 1]]);
+            if (FromCluster != Hierarchy.GetClusterIndex(Graph.NodeIDs[Corridor[i]]))
+            {
+                OutPath.Add(Corridor[i]);
+                continue;
+            }
+
+            Hierarchy.GetClusterBounds(FromCluster, Min, Max);
+            if (!SearchInBounds(Graph, Min, Max, Corridor[i - 1], Corridor[i], Context))
+            {
+                OutPath.Reset();
+                return false;
+            }
+            Context.BuildPath(Corridor[i], Segment);
+            OutPath.Append(Segment.GetData() + 1, Segment.Num() - 1);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+    PathfindingHierarchy.h
+    Purpose: Header file for the HPA* cluster layer over the pathfinding graph.
+    The grid is split into fixed-size square clusters. Entrances are placed where two neighboring clusters share walkable border cells,
+    and the cost between every pair of entrances of a cluster is precomputed. Long queries search this small abstract graph first
+    and then refine only the chosen corridor on the grid, one cluster at a time.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPathfindingGraph;
+class FPathfindingSearchContext;
+
+// Cluster layer of the pathfinding graph
+struct WALLCLIMBER_ANDRE_API FPathfindingHierarchy
+{
+public:
+    // Width and height of a cluster in grid cells
+    static constexpr int32 ClusterSize = 16;
+
+    // Walkable border runs at least this long get an entrance at each end instead of a single one in the middle
+    static constexpr int32 LongEntranceLength = 6;
+
+    // Node of a cluster that steps directly into a neighboring cluster
+    struct FEntrance
+    {
+        // Graph index of the entrance node
+        int32 NodeIndex = INDEX_NONE;
+
+        // Graph indices of the entrance nodes across the border this node steps to
+        TArray<int32, TInlineAllocator<2>> Links;
+    };
+
+    struct FCluster
+    {
+        TArray<FEntrance> Entrances;
+
+        // Cost between each pair of entrances without leaving the cluster, MAX_int32 if one cannot reach the other
+        TArray<int32> IntraCosts;
+
+        int32 GetIntraCost(int32 FromEntrance, int32 ToEntrance) const
+        {
+            return IntraCosts[FromEntrance * Entrances.Num() + ToEntrance];
+        }
+
+        // Entrance slot of a graph node, INDEX_NONE if the node is not an entrance of this cluster
+        int32 FindEntrance(int32 NodeIndex) const;
+    };
+
+    // Computes the entrances and intra-cluster costs of every cluster of the graph
+    void Build(const FPathfindingGraph& Graph);
+
+    // Recomputes only the clusters affected by a validity change of the given grid IDs
+    // A change on a cluster border also dirties the cluster across that border, since their shared entrances may move
+    void Update(const FPathfindingGraph& Graph, const TArray<FIntPoint>& ChangedIDs);
+
+    // Whether the layer has been computed for the graph's grid
+    bool IsBuiltFor(const FPathfindingGraph& Graph) const;
+
+    // Index of the cluster containing a grid ID
+    int32 GetClusterIndex(const FIntPoint& ID) const
+    {
+        return (ID.X / ClusterSize) * NumClustersY + ID.Y / ClusterSize;
+    }
+
+    // Inclusive grid ID bounds of a cluster
+    void GetClusterBounds(int32 ClusterIndex, FIntPoint& OutMin, FIntPoint& OutMax) const;
+
+    const FCluster& GetCluster(int32 ClusterIndex) const { return *Clusters[ClusterIndex]; }
+
+private:
+    // Places the entrances of one cluster along its four borders and computes the costs between them
+    TSharedRef<const FCluster, ESPMode::ThreadSafe> BuildCluster(const FPathfindingGraph& Graph, int32 ClusterIndex, FPathfindingSearchContext& Context) const;
+
+    int32 GridSizeX = 0;
+    int32 GridSizeY = 0;
+    int32 NumClustersX = 0;
+    int32 NumClustersY = 0;
+
+    // Clusters are never modified once built, so copies of the layer share the ones an update does not rebuild
+    TArray<TSharedPtr<const FCluster, ESPMode::ThreadSafe>> Clusters;
+};
+
+namespace PathfindingSearch
+{
+    // Finds a path between two nodes with HPA*: searches the cluster entrances first, then refines the corridor cluster by cluster
+    // Paths are near-optimal rather than optimal. Falls back to A* if the cluster layer has not been built. Returns false if no path exists
+    WALLCLIMBER_ANDRE_API bool FindHierarchicalPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath);
+}
@@ -0,0 +1,396 @@
+/*
+    PathfindingJumpPoints.cpp
+    Purpose: Implementation of the JPS+ jump distance table and of the Jump Point Search over the pathfinding graph.
+    The movement rules are the ones of the A* search: 8-connected, 10/14 costs, and diagonal moves may not cut corners.
+    Under those rules the only forced neighbors appear beside cross moves, so diagonal jump points are the nodes from which
+    a cross scan finds a jump point.
+*/
+
+#include "PathfindingJumpPoints.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+#include "Algo/Reverse.h"
+
+const FIntPoint FPathfindingJumpTable::Directions[8] =
+{
+    FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1),
+    FIntPoint(1, 1), FIntPoint(1, -1), FIntPoint(-1, 1), FIntPoint(-1, -1)
+};
+
+// Index of a unit direction in Directions
+int32 FPathfindingJumpTable::GetDirectionIndex(const FIntPoint& Direction)
+{
+    // Indexed by (X + 1) * 3 + (Y + 1)
+    static const int32 DirectionIndices[9] = { 7, 1, 6, 3, INDEX_NONE, 2, 5, 0, 4 };
+    return DirectionIndices[(Direction.X + 1) * 3 + (Direction.Y + 1)];
+}
+
+namespace
+{
+    bool IsWalkable(const FPathfindingGraph& Graph, const FIntPoint& ID)
+    {
+        return Graph.FindValidNode(ID) != INDEX_NONE;
+    }
+
+    // Whether a node reached by a cross move has a forced neighbor: a valid side cell that could not have been
+    // reached diagonally from the previous node because the cell behind it is blocked
+    bool HasForcedNeighbor(const FPathfindingGraph& Graph, const FIntPoint& ID, const FIntPoint& Direction)
+    {
+        const FIntPoint Side(Direction.Y, Direction.X);
+        return (IsWalkable(Graph, ID + Side) && !IsWalkable(Graph, ID + Side - Direction))
+            || (IsWalkable(Graph, ID - Side) && !IsWalkable(Graph, ID - Side - Direction));
+    }
+
+    // Directions worth scanning from a node, given the direction it was reached from. Returns how many were written
+    int32 GetPrunedDirections(const FPathfindingGraph& Graph, const FIntPoint& ID, const FIntPoint& Direction, int32 OutDirectionIndices[8])
+    {
+        // The start node scans everywhere
+        if (Direction == FIntPoint::ZeroValue)
+        {
+            for (int32 DirectionIndex = 0; DirectionIndex < 8; ++DirectionIndex)
+            {
+                OutDirectionIndices[DirectionIndex] = DirectionIndex;
+            }
+            return 8;
+        }
+
+        int32 NumDirections = 0;
+
+        // Diagonal moves continue diagonally and along both of their cross components
+        if (Direction.X != 0 && Direction.Y != 0)
+        {
+            OutDirectionIndices[NumDirections++] = FPathfindingJumpTable::GetDirectionIndex(FIntPoint(Direction.X, 0));
+            OutDirectionIndices[NumDirections++] = FPathfindingJumpTable::GetDirectionIndex(FIntPoint(0, Direction.Y));
+            OutDirectionIndices[NumDirections++] = FPathfindingJumpTable::GetDirectionIndex(Direction);
+            return NumDirections;
+        }
+
+        // Cross moves continue straight, and turn towards forced neighbors
+        OutDirectionIndices[NumDirections++] = FPathfindingJumpTable::GetDirectionIndex(Direction);
+
+        const FIntPoint Side(Direction.Y, Direction.X);
+        for (const FIntPoint& SideOffset : { Side, Side * -1 })
+        {
+            if (IsWalkable(Graph, ID + SideOffset) && !IsWalkable(Graph, ID + SideOffset - Direction))
+            {
+                OutDirectionIndices[NumDirections++] = FPathfindingJumpTable::GetDirectionIndex(SideOffset);
+                OutDirectionIndices[NumDirections++] = FPathfindingJumpTable::GetDirectionIndex(SideOffset + Direction);
+            }
+        }
+
+        return NumDirections;
+    }
+
+    // Scans from a node in one direction and returns the first jump point, or the goal if the scan reaches it first
+    // Returns INDEX_NONE if the scan is blocked before finding either
+    int32 Jump(const FPathfindingGraph& Graph, int32 NodeIndex, int32 DirectionIndex, const FIntPoint& GoalID, int32& OutSteps)
+    {
+        const FPathfindingJumpTable& JumpTable = Graph.JumpTable;
+        const FIntPoint ID = Graph.NodeIDs[NodeIndex];
+        const FIntPoint Direction = FPathfindingJumpTable::Directions[DirectionIndex];
+        const int32 Distance = JumpTable.GetJumpDistance(NodeIndex, DirectionIndex);
+        const int32 MaxSteps = FMath::Abs(Distance);
+        const FIntPoint ToGoal = GoalID - ID;
+
+        if (Direction.X == 0 || Direction.Y == 0)
+        {
+            // The goal stops a cross scan if it lies on the ray within reach
+            const bool bGoalOnRay = (Direction.X != 0) ? ToGoal.Y == 0 : ToGoal.X == 0;
+            const int32 GoalSteps = ToGoal.X * Direction.X + ToGoal.Y * Direction.Y;
+            if (bGoalOnRay && GoalSteps > 0 && GoalSteps <= MaxSteps)
+            {
+                OutSteps = GoalSteps;
+                return Graph.FindValidNode(GoalID);
+            }
+        }
+        else
+        {
+            // A diagonal scan stops where the goal lies ahead along one of its cross components. Only the two steps that line up
+            // with the goal's row or column need checking, and before the first jump point the cross distances are wall distances
+            const int32 StraightX = FPathfindingJumpTable::GetDirectionIndex(FIntPoint(Direction.X, 0));
+            const int32 StraightY = FPathfindingJumpTable::GetDirectionIndex(FIntPoint(0, Direction.Y));
+
+            int32 CandidateSteps[2] = { ToGoal.X * Direction.X, ToGoal.Y * Direction.Y };
+            if (CandidateSteps[0] > CandidateSteps[1])
+            {
+                Swap(CandidateSteps[0], CandidateSteps[1]);
+            }
+
+            for (const int32 Steps : CandidateSteps)
+            {
+                if (Steps <= 0 || Steps > MaxSteps || (Distance > 0 && Steps >= Distance))
+                {
+                    continue;
+                }
+
+                const FIntPoint StepID = ID + Direction * Steps;
+                const int32 StepIndex = Graph.FindValidNode(StepID);
+                const FIntPoint StepToGoal = GoalID - StepID;
+
+                const bool bReachesAlongX = StepToGoal.Y == 0 && StepToGoal.X * Direction.X >= 0
+                    && StepToGoal.X * Direction.X <= -JumpTable.GetJumpDistance(StepIndex, StraightX);
+                const bool bReachesAlongY = StepToGoal.X == 0 && StepToGoal.Y * Direction.Y >= 0
+                    && StepToGoal.Y * Direction.Y <= -JumpTable.GetJumpDistance(StepIndex, StraightY);
+
+                if (bReachesAlongX || bReachesAlongY)
+                {
+                    OutSteps = Steps;
+                    return StepIndex;
+                }
+            }
+        }
+
+        if (Distance > 0)
+        {
+            OutSteps = Distance;
+            return Graph.FindValidNode(ID + Direction * Distance);
+        }
+
+        return INDEX_NONE;
+    }
+}
+
+// Computes the jump distances of every valid node of the graph
+void FPathfindingJumpTable::Build(const FPathfindingGraph& Graph)
+{
+    const FNavigationGridIndex& Lookup = Graph.NodeIndexLookup;
+    check(Lookup.SizeX < MAX_int16 && Lookup.SizeY < MAX_int16);
+
+    JumpDistances.Init(0, Graph.Num() * 8);
+
+    // Cross directions come first in Directions, diagonal distances depend on them
+    for (int32 DirectionIndex = 0; DirectionIndex < 8; ++DirectionIndex)
+    {
+        const FIntPoint Direction = Directions[DirectionIndex];
+
+        // Visit the cells against the scan direction, so the next cell along it is always computed first
+        for (int32 StepX = 0; StepX < Lookup.SizeX; ++StepX)
+        {
+            const int32 X = (Direction.X > 0) ? Lookup.SizeX - 1 - StepX : StepX;
+            for (int32 StepY = 0; StepY < Lookup.SizeY; ++StepY)
+            {
+                const int32 Y = (Direction.Y > 0) ? Lookup.SizeY - 1 - StepY : StepY;
+                const FIntPoint ID(X, Y);
+
+                const int32 NodeIndex = Graph.FindValidNode(ID);
+                if (NodeIndex != INDEX_NONE)
+                {
+                    JumpDistances.GetMutable(NodeIndex * 8 + DirectionIndex) = static_cast<int16>(ComputeJumpDistance(Graph, ID, DirectionIndex));
+                }
+            }
+        }
+    }
+}
+
+// Recomputes the jump distances that read the changed cells, walking back along each affected line only while the distances keep changing
+void FPathfindingJumpTable::Repair(const FPathfindingGraph& Graph, const TArray<FIntPoint>& ChangedIDs)
+{
+    const FNavigationGridIndex& Lookup = Graph.NodeIndexLookup;
+    if (JumpDistances.Num() == 0 || JumpDistances.Num() > Graph.Num() * 8)
+    {
+        Build(Graph);
+        return;
+    }
+
+    // Nodes appended for cells that gained one start with no moves, the changed cells below recompute them
+    JumpDistances.SetNum(Graph.Num() * 8, 0);
+
+    // Cells whose cross distances changed, by direction. Diagonal distances read them one step back along the diagonal
+    TArray<FIntPoint> ChangedCrossCells[4];
+
+    // Cross directions come first in Directions, diagonal distances depend on them
+    for (int32 DirectionIndex = 0; DirectionIndex < 8; ++DirectionIndex)
+    {
+        const FIntPoint Direction = Directions[DirectionIndex];
+        const bool bDiagonal = Direction.X != 0 && Direction.Y != 0;
+
+        // Cells whose distance reads the validity of a changed cell directly. The distances behind them are reached by the walk below
+        TArray<FIntPoint> Seeds;
+        for (const FIntPoint& ID : ChangedIDs)
+        {
+            if (bDiagonal)
+            {
+                // The next cell along the diagonal and the two corner cells of the move
+                Seeds.Append({ ID, ID - Direction, ID - FIntPoint(Direction.X, 0), ID - FIntPoint(0, Direction.Y) });
+            }
+            else
+            {
+                // The next cell along the direction, and the side cells of its forced neighbor check
+                const FIntPoint Side(Direction.Y, Direction.X);
+                Seeds.Append({ ID, ID - Direction, ID + Side, ID - Side, ID - Direction + Side, ID - Direction - Side });
+            }
+        }
+        if (bDiagonal)
+        {
+            for (const FIntPoint& ID : ChangedCrossCells[GetDirectionIndex(FIntPoint(Direction.X, 0))])
+            {
+                Seeds.Add(ID - Direction);
+            }
+            for (const FIntPoint& ID : ChangedCrossCells[GetDirectionIndex(FIntPoint(0, Direction.Y))])
+            {
+                Seeds.Add(ID - Direction);
+            }
+        }
+        Seeds.RemoveAll([&Lookup](const FIntPoint& ID) { return !Lookup.IsInside(ID); });
+
+        // Cells on one line along the direction share Line, and Progress grows along the direction
+        auto GetLine = [&Direction](const FIntPoint& ID) { return ID.X * Direction.Y - ID.Y * Direction.X; };
+        auto GetProgress = [&Direction](const FIntPoint& ID) { return ID.X * Direction.X + ID.Y * Direction.Y; };
+
+        // Line by line, the seed furthest along the direction first, so the next cell along it is always final when a cell is recomputed
+        Seeds.Sort([&GetLine, &GetProgress](const FIntPoint& A, const FIntPoint& B)
+        {
+            return GetLine(A) != GetLine(B) ? GetLine(A) < GetLine(B) : GetProgress(A) > GetProgress(B);
+        });
+
+        for (int32 SeedIndex = 0; SeedIndex < Seeds.Num();)
+        {
+            const int32 Line = GetLine(Seeds[SeedIndex]);
+            FIntPoint ID = Seeds[SeedIndex];
+            while (true)
+            {
+                bool bChanged = false;
+                const int32 NodeIndex = Lookup.Find(ID);
+                if (NodeIndex != INDEX_NONE)
+                {
+                    const int16 Distance = static_cast<int16>(ComputeJumpDistance(Graph, ID, DirectionIndex));
+                    if (Distance != JumpDistances[NodeIndex * 8 + DirectionIndex])
+                    {
+                        JumpDistances.GetMutable(NodeIndex * 8 + DirectionIndex) = Distance;
+                        bChanged = true;
+                        if (!bDiagonal)
+                        {
+                            ChangedCrossCells[DirectionIndex].Add(ID);
+                        }
+                    }
+                }
+
+                // Seeds at or ahead of this cell on the line are covered
+                while (SeedIndex < Seeds.Num() && GetLine(Seeds[SeedIndex]) == Line && GetProgress(Seeds[SeedIndex]) >= GetProgress(ID))
+                {
+                    ++SeedIndex;
+                }
+
+                // The cell behind reads this distance, so it is only stale if this one changed. Otherwise skip to the next seed behind
+                if (bChanged && Lookup.IsInside(ID - Direction))
+                {
+                    ID -= Direction;
+                }
+                else if (SeedIndex < Seeds.Num() && GetLine(Seeds[SeedIndex]) == Line)
+                {
+                    ID = Seeds[SeedIndex];
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Jump distance of a cell in one direction from the validity around it and the distances of the next cell along the direction
+int32 FPathfindingJumpTable::ComputeJumpDistance(const FPathfindingGraph& Graph, const FIntPoint& ID, int32 DirectionIndex) const
+{
+    const FIntPoint Direction = Directions[DirectionIndex];
+    const int32 NextIndex = Graph.FindNeighbor(ID, Direction);
+    if (Graph.FindValidNode(ID) == INDEX_NONE || NextIndex == INDEX_NONE)
+    {
+        return 0;
+    }
+
+    const bool bNextIsJumpPoint = (Direction.X != 0 && Direction.Y != 0)
+        ? GetJumpDistance(NextIndex, GetDirectionIndex(FIntPoint(Direction.X, 0))) > 0 || GetJumpDistance(NextIndex, GetDirectionIndex(FIntPoint(0, Direction.Y))) > 0
+        : HasForcedNeighbor(Graph, ID + Direction, Direction);
+
+    const int32 NextDistance = GetJumpDistance(NextIndex, DirectionIndex);
+    return bNextIsJumpPoint ? 1 : (NextDistance > 0 ? NextDistance + 1 : NextDistance - 1);
+}
+
+namespace PathfindingSearch
+{
+    bool FindJumpPointPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath)
+    {
+        OutPath.Reset();
+        if (!Graph.IsValidIndex(StartIndex) || !Graph.IsValidIndex(EndIndex) || !Graph.JumpTable.IsBuiltFor(Graph.Num()))
+        {
+            return false;
+        }
+
+        Context.BeginQuery(Graph.Num());
+        FPathfindingOpenSet& OpenSet = Context.GetOpenSet();
+        const FIntPoint GoalID = Graph.NodeIDs[EndIndex];
+
+        const int32 StartHCost = Graph.GetHeuristic(StartIndex, EndIndex);
+        Context.SetNode(StartIndex, 0, INDEX_NONE);
+        OpenSet.Push(StartIndex, StartHCost, StartHCost);
+
+        while (!OpenSet.IsEmpty())
+        {
+            if (Context.IsCancelled())
+            {
+                return false;
+            }
+
+            const int32 CurrentIndex = OpenSet.Pop();
+            Context.Close(CurrentIndex);
+
+            if (CurrentIndex == EndIndex)
+            {
+                // The parents only link jump points, fill in the straight and diagonal runs between them
+                TArray<int32> JumpPoints;
+                Context.BuildPath(EndIndex, JumpPoints);
+
+                OutPath.Add(JumpPoints[0]);
+                for (int32 i = 1; i < JumpPoints.Num(); ++i)
+                {
+                    const FIntPoint FromID = Graph.NodeIDs[JumpPoints[i - 1]];
+                    const FIntPoint ToID = Graph.NodeIDs[JumpPoints[i]];
+                    const FIntPoint Step(FMath::Sign(ToID.X - FromID.X), FMath::Sign(ToID.Y - FromID.Y));
+                    for (FIntPoint ID = FromID + Step; ID != ToID; ID += Step)
+                    {
+                        OutPath.Add(Graph.FindValidNode(ID));
+                    }
+                    OutPath.Add(JumpPoints[i]);
+                }
+                return true;
+            }
+
+            const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+            const int32 CurrentGCost = Context.GetGCost(CurrentIndex);
+            const int32 ParentIndex = Context.GetParent(CurrentIndex);
+
+            FIntPoint ArrivalDirection = FIntPoint::ZeroValue;
+            if (ParentIndex != INDEX_NONE)
+            {
+                const FIntPoint ParentID = Graph.NodeIDs[ParentIndex];
+                ArrivalDirection = FIntPoint(FMath::Sign(CurrentID.X - ParentID.X), FMath::Sign(CurrentID.Y - ParentID.Y));
+            }
+
+            int32 DirectionIndices[8];
+            const int32 NumDirections = GetPrunedDirections(Graph, CurrentID, ArrivalDirection, DirectionIndices);
+
+            for (int32 i = 0; i < NumDirections; ++i)
+            {
+                int32 Steps = 0;
+                const int32 JumpIndex = Jump(Graph, CurrentIndex, DirectionIndices[i], GoalID, Steps);
+                if (JumpIndex == INDEX_NONE || Context.IsClosed(JumpIndex))
+                {
+                    continue;
+                }
+
+                const int32 TentativeGScore = CurrentGCost + Steps * FPathfindingGraph::GetMovementCost(FPathfindingJumpTable::Directions[DirectionIndices[i]]);
+                if (TentativeGScore >= Context.GetGCost(JumpIndex))
+                {
+                    continue;
+                }
+
+                const int32 HCost = Graph.GetHeuristic(JumpIndex, EndIndex);
+                Context.SetNode(JumpIndex, TentativeGScore, CurrentIndex);
+                OpenSet.Push(JumpIndex, TentativeGScore + HCost, HCost);
+            }
+        }
+
+        return false;
+    }
+}
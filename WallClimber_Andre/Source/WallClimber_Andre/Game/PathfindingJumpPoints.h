@@ -0,0 +1,57 @@
+/*
+    PathfindingJumpPoints.h
+    Purpose: Header file for Jump Point Search (JPS+) over the pathfinding graph.
+    The jump distance table is precomputed when the graph is built. At query time straight and diagonal scans read the table
+    instead of walking the grid cell by cell, so long runs over open surfaces cost O(1) per jump.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationPagedArray.h"
+
+struct FPathfindingGraph;
+class FPathfindingSearchContext;
+
+// Precomputed JPS+ jump distances, eight per node
+// A positive distance is the number of steps to the next jump point in that direction.
+// Zero or a negative distance is minus the number of steps that can be taken before the scan is blocked
+struct WALLCLIMBER_ANDRE_API FPathfindingJumpTable
+{
+public:
+    // Scan directions: the four cross directions first, then the four diagonals
+    static const FIntPoint Directions[8];
+
+    // Index of a unit direction in Directions
+    static int32 GetDirectionIndex(const FIntPoint& Direction);
+
+    // Computes the jump distances of every valid node of the graph
+    void Build(const FPathfindingGraph& Graph);
+
+    // Recomputes the jump distances that read the changed cells, walking back along each affected line only while the distances keep changing
+    // Slots of nodes the graph retired keep their old distances, they are never read while the node stays invalid
+    void Repair(const FPathfindingGraph& Graph, const TArray<FIntPoint>& ChangedIDs);
+
+    // Jump distance of a node in one of the eight directions
+    int32 GetJumpDistance(int32 NodeIndex, int32 DirectionIndex) const
+    {
+        return JumpDistances[NodeIndex * 8 + DirectionIndex];
+    }
+
+    // Whether the table has been computed for a graph of NumNodes nodes
+    bool IsBuiltFor(int32 NumNodes) const { return JumpDistances.Num() == NumNodes * 8; }
+
+private:
+    // Jump distance of a cell in one direction from the validity around it and the distances of the next cell along the direction
+    int32 ComputeJumpDistance(const FPathfindingGraph& Graph, const FIntPoint& ID, int32 DirectionIndex) const;
+
+    // Shares its pages with the tables of earlier graph versions until a repair writes to them
+    TNavigationPagedArray<int16> JumpDistances;
+};
+
+namespace PathfindingSearch
+{
+    // Finds the shortest path between two nodes using Jump Point Search and writes every node index along it into OutPath
+    // Returns the same path cost as FindAStarPath. Returns false if no path exists
+    WALLCLIMBER_ANDRE_API bool FindJumpPointPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath);
+}
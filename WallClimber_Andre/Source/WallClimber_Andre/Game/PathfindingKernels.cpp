@@ -0,0 +1,57 @@
+/*
+    PathfindingKernels.cpp
+    Purpose: Implementation of the runtime choice between the A* kernel specializations.
+*/
+
+#include "PathfindingKernels.h"
+
+namespace PathfindingKernels
+{
+    namespace
+    {
+        template <typename ConnectivityPolicy, typename HeuristicPolicy>
+        bool FindPathWithCost(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath,
+            const FPathfindingSearchPolicies& Policies)
+        {
+            if (Policies.Cost == EPathfindingCostPolicy::Uniform)
+            {
+                return FindPath<ConnectivityPolicy, HeuristicPolicy, FUniformCost>(Graph, StartIndex, EndIndex, Context, OutPath);
+            }
+            return FindPath<ConnectivityPolicy, HeuristicPolicy, FOctileCost>(Graph, StartIndex, EndIndex, Context, OutPath);
+        }
+
+        template <typename ConnectivityPolicy>
+        bool FindPathWithHeuristic(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath,
+            const FPathfindingSearchPolicies& Policies)
+        {
+            switch (Policies.Heuristic)
+            {
+            case EPathfindingHeuristic::Euclidean:
+                return FindPathWithCost<ConnectivityPolicy, FEuclideanHeuristic>(Graph, StartIndex, EndIndex, Context, OutPath, Policies);
+            case EPathfindingHeuristic::Manhattan:
+                return FindPathWithCost<ConnectivityPolicy, FManhattanHeuristic>(Graph, StartIndex, EndIndex, Context, OutPath, Policies);
+            case EPathfindingHeuristic::Landmark:
+                // Landmark tables are in 10/14 costs, under uniform costs they would overestimate
+                if (Policies.Cost == EPathfindingCostPolicy::Octile)
+                {
+                    return FindPath<ConnectivityPolicy, FLandmarkHeuristic, FOctileCost>(Graph, StartIndex, EndIndex, Context, OutPath);
+                }
+                return FindPath<ConnectivityPolicy, FOctileHeuristic, FUniformCost>(Graph, StartIndex, EndIndex, Context, OutPath);
+            case EPathfindingHeuristic::Octile:
+            default:
+                return FindPathWithCost<ConnectivityPolicy, FOctileHeuristic>(Graph, StartIndex, EndIndex, Context, OutPath, Policies);
+            }
+        }
+    }
+
+    // Runs the FindPath specialization that matches the runtime policies
+    bool FindPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath,
+        const FPathfindingSearchPolicies& Policies)
+    {
+        if (Policies.Connectivity == EPathfindingConnectivity::Four)
+        {
+            return FindPathWithHeuristic<FFourConnected>(Graph, StartIndex, EndIndex, Context, OutPath, Policies);
+        }
+        return FindPathWithHeuristic<FEightConnected>(Graph, StartIndex, EndIndex, Context, OutPath, Policies);
+    }
+}
@@ -0,0 +1,219 @@
+/*
+    PathfindingKernels.h
+    Purpose: Header file for the A* search kernel compiled once per combination of connectivity, heuristic and cost policy.
+    Each policy is a compile-time constant of its specialization, so the expansion loop carries no branch or indirection
+    for it. FindPath picks the specialization that matches a set of runtime policies.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+#include <type_traits>
+#include "PathfindingKernels.generated.h"
+
+// Moves a search may take between nodes
+UENUM(BlueprintType)
+enum class EPathfindingConnectivity : uint8
+{
+    // Cross and diagonal moves, diagonals never cutting a corner
+    Eight,
+    // Cross moves only
+    Four
+};
+
+// Estimate of the remaining cost that orders the open set
+UENUM(BlueprintType)
+enum class EPathfindingHeuristic : uint8
+{
+    // The larger of octile distance and the ALT landmark bound. Tightest estimate, needs the Octile cost policy
+    Landmark,
+    // Exact cost on open ground for 8-connected moves
+    Octile,
+    // Straight-line length at the cheapest cost per unit of length. Admissible for every connectivity and cost policy
+    Euclidean,
+    // Exact cost on open ground for 4-connected moves. Overestimates diagonal moves, so 8-connected paths can come out longer than optimal
+    Manhattan
+};
+
+// Cost of a single move
+UENUM(BlueprintType)
+enum class EPathfindingCostPolicy : uint8
+{
+    // 10 for a cross move, 14 for a diagonal move
+    Octile,
+    // 10 for every move, so paths take the fewest steps
+    Uniform
+};
+
+// Policies the A* kernel is specialized for
+USTRUCT(BlueprintType)
+struct FPathfindingSearchPolicies
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+    EPathfindingConnectivity Connectivity = EPathfindingConnectivity::Eight;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+    EPathfindingHeuristic Heuristic = EPathfindingHeuristic::Landmark;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pathfinding")
+    EPathfindingCostPolicy Cost = EPathfindingCostPolicy::Octile;
+
+    // The three policies packed into the low four bits, so they can extend a cache key
+    uint8 GetKey() const
+    {
+        return static_cast<uint8>(Connectivity) | (static_cast<uint8>(Heuristic) << 1) | (static_cast<uint8>(Cost) << 3);
+    }
+};
+
+namespace PathfindingKernels
+{
+    // Cell steps of the move directions, in the order of FPathfindingJumpTable::Directions and of the bits of the neighbor masks
+    constexpr int32 DirectionX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    constexpr int32 DirectionY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+    // Connectivity policies: the neighbor mask bits a search may follow
+    struct FEightConnected
+    {
+        static constexpr uint8 MoveMask = 0xFF;
+    };
+
+    struct FFourConnected
+    {
+        static constexpr uint8 MoveMask = 0x0F;
+    };
+
+    // Cost policies: the cost of a move in each direction, and the cheapest cost per cell of straight-line length
+    struct FOctileCost
+    {
+        static constexpr int32 Costs[8] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+        static constexpr int32 Straight = 10;
+        static constexpr int32 Diagonal = 14;
+        static constexpr double CostPerUnitLength = 9.8994949366116654; // 14 / sqrt(2)
+    };
+
+    struct FUniformCost
+    {
+        static constexpr int32 Costs[8] = { 10, 10, 10, 10, 10, 10, 10, 10 };
+        static constexpr int32 Straight = 10;
+        static constexpr int32 Diagonal = 10;
+        static constexpr double CostPerUnitLength = 7.0710678118654752; // 10 / sqrt(2)
+    };
+
+    // Heuristic policies, each measured in the units of the cost policy
+    struct FOctileHeuristic
+    {
+        template <typename CostPolicy>
+        static int32 Estimate(const FPathfindingGraph& Graph, int32 FromIndex, int32 ToIndex)
+        {
+            const FIntPoint Delta = Graph.NodeIDs[FromIndex] - Graph.NodeIDs[ToIndex];
+            const int32 DeltaX = FMath::Abs(Delta.X);
+            const int32 DeltaY = FMath::Abs(Delta.Y);
+            return CostPolicy::Straight * FMath::Max(DeltaX, DeltaY) + (CostPolicy::Diagonal - CostPolicy::Straight) * FMath::Min(DeltaX, DeltaY);
+        }
+    };
+
+    struct FEuclideanHeuristic
+    {
+        template <typename CostPolicy>
+        static int32 Estimate(const FPathfindingGraph& Graph, int32 FromIndex, int32 ToIndex)
+        {
+            const FIntPoint Delta = Graph.NodeIDs[FromIndex] - Graph.NodeIDs[ToIndex];
+            return FMath::FloorToInt(CostPolicy::CostPerUnitLength * FMath::Sqrt(static_cast<double>(Delta.X * Delta.X + Delta.Y * Delta.Y)));
+        }
+    };
+
+    struct FManhattanHeuristic
+    {
+        template <typename CostPolicy>
+        static int32 Estimate(const FPathfindingGraph& Graph, int32 FromIndex, int32 ToIndex)
+        {
+            const FIntPoint Delta = Graph.NodeIDs[FromIndex] - Graph.NodeIDs[ToIndex];
+            return CostPolicy::Straight * (FMath::Abs(Delta.X) + FMath::Abs(Delta.Y));
+        }
+    };
+
+    struct FLandmarkHeuristic
+    {
+        template <typename CostPolicy>
+        static int32 Estimate(const FPathfindingGraph& Graph, int32 FromIndex, int32 ToIndex)
+        {
+            static_assert(std::is_same_v<CostPolicy, FOctileCost>, "Landmark tables hold 10/14 costs and would overestimate other cost policies");
+            return Graph.GetLandmarkHeuristic(FromIndex, ToIndex);
+        }
+    };
+
+    // Finds the cheapest path between two nodes under the given policies and writes its node indices into OutPath
+    // Nodes reached again at a lower cost are queued again, so heuristics that are admissible but not consistent still give optimal paths
+    template <typename ConnectivityPolicy, typename HeuristicPolicy, typename CostPolicy>
+    bool FindPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath)
+    {
+        OutPath.Reset();
+        if (!Graph.IsValidIndex(StartIndex) || !Graph.IsValidIndex(EndIndex))
+        {
+            return false;
+        }
+
+        // Row-major cell steps of the move directions on this grid
+        const int32 SizeY = Graph.NodeIndexLookup.SizeY;
+        const TNavigationPagedArray<int32>& CellNodeIndices = Graph.NodeIndexLookup.NodeIndices;
+        int32 CellOffsets[8];
+        for (int32 Direction = 0; Direction < 8; ++Direction)
+        {
+            CellOffsets[Direction] = DirectionX[Direction] * SizeY + DirectionY[Direction];
+        }
+
+        Context.BeginQuery(Graph.Num());
+        FPathfindingOpenSet& OpenSet = Context.GetOpenSet();
+
+        const int32 StartHCost = HeuristicPolicy::template Estimate<CostPolicy>(Graph, StartIndex, EndIndex);
+        Context.SetNode(StartIndex, 0, INDEX_NONE);
+        OpenSet.Push(StartIndex, StartHCost, StartHCost);
+
+        while (!OpenSet.IsEmpty())
+        {
+            if (Context.IsCancelled())
+            {
+                return false;
+            }
+
+            const int32 CurrentIndex = OpenSet.Pop();
+            Context.Close(CurrentIndex);
+
+            if (CurrentIndex == EndIndex)
+            {
+                Context.BuildPath(EndIndex, OutPath);
+                return true;
+            }
+
+            const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+            const int32 CurrentCell = CurrentID.X * SizeY + CurrentID.Y;
+            const int32 CurrentGCost = Context.GetGCost(CurrentIndex);
+
+            for (uint32 Moves = Graph.NeighborMasks[CurrentIndex] & ConnectivityPolicy::MoveMask; Moves != 0; Moves &= Moves - 1)
+            {
+                const int32 Direction = FMath::CountTrailingZeros(Moves);
+                const int32 NeighborIndex = CellNodeIndices[CurrentCell + CellOffsets[Direction]];
+
+                const int32 TentativeGScore = CurrentGCost + CostPolicy::Costs[Direction];
+                if (TentativeGScore >= Context.GetGCost(NeighborIndex))
+                {
+                    continue;
+                }
+
+                const int32 HCost = HeuristicPolicy::template Estimate<CostPolicy>(Graph, NeighborIndex, EndIndex);
+                Context.SetNode(NeighborIndex, TentativeGScore, CurrentIndex);
+                OpenSet.Push(NeighborIndex, TentativeGScore + HCost, HCost);
+            }
+        }
+
+        return false;
+    }
+
+    // Runs the FindPath specialization that matches the runtime policies. The Landmark heuristic falls back to Octile under the Uniform cost policy
+    WALLCLIMBER_ANDRE_API bool FindPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath,
+        const FPathfindingSearchPolicies& Policies);
+}
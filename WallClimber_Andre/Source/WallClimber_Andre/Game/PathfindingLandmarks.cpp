@@ -0,0 +1,313 @@
+/*
+    PathfindingLandmarks.cpp
+    Purpose: Implementation of the landmark selection and cost tables of the ALT heuristic.
+*/
+
+#include "PathfindingLandmarks.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Dijkstra flood from one node over the whole graph. OutCosts receives the cost of every node, MAX_int32 where it is not reached
+    void ComputeCosts(const FPathfindingGraph& Graph, int32 SourceIndex, FPathfindingSearchContext& Context, TArray<int32>& OutCosts)
+    {
+        Context.BeginQuery(Graph.Num());
+        FPathfindingOpenSet& OpenSet = Context.GetOpenSet();
+        Context.SetNode(SourceIndex, 0, INDEX_NONE);
+        OpenSet.Push(SourceIndex, 0, 0);
+
+        while (!OpenSet.IsEmpty())
+        {
+            const int32 CurrentIndex = OpenSet.Pop();
+            Context.Close(CurrentIndex);
+
+            const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+            const int32 CurrentGCost = Context.GetGCost(CurrentIndex);
+
+            for (uint32 Moves = Graph.NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+            {
+                const int32 Direction = FMath::CountTrailingZeros(Moves);
+                const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+                const int32 NeighborIndex = Graph.GetNeighbor(CurrentID, Direction);
+                if (Context.IsClosed(NeighborIndex))
+                {
+                    continue;
+                }
+
+                const int32 TentativeGScore = CurrentGCost + FPathfindingGraph::GetMovementCost(NeighborOffset);
+                if (TentativeGScore < Context.GetGCost(NeighborIndex))
+                {
+                    Context.SetNode(NeighborIndex, TentativeGScore, CurrentIndex);
+                    OpenSet.Push(NeighborIndex, TentativeGScore, 0);
+                }
+            }
+        }
+
+        OutCosts.SetNumUninitialized(Graph.Num());
+        for (int32 NodeIndex = 0; NodeIndex < Graph.Num(); ++NodeIndex)
+        {
+            OutCosts[NodeIndex] = Context.GetGCost(NodeIndex);
+        }
+    }
+
+    // Valid node with the highest cost, skipping nodes at zero cost. INDEX_NONE if there is none
+    int32 FindFarthestNode(const FPathfindingGraph& Graph, const TArray<int32>& NodeCosts)
+    {
+        int32 FarthestIndex = INDEX_NONE;
+        int32 FarthestCost = 0;
+        for (int32 NodeIndex = 0; NodeIndex < Graph.Num(); ++NodeIndex)
+        {
+            if (Graph.IsNodeValid(NodeIndex) && NodeCosts[NodeIndex] > FarthestCost)
+            {
+                FarthestIndex = NodeIndex;
+                FarthestCost = NodeCosts[NodeIndex];
+            }
+        }
+        return FarthestIndex;
+    }
+}
+
+// Picks up to MaxLandmarks landmarks that fit in MemoryBudgetBytes and computes their cost tables
+void FPathfindingLandmarks::Build(const FPathfindingGraph& Graph, int32 MaxLandmarks, int64 MemoryBudgetBytes)
+{
+    NumLandmarks = 0;
+    LandmarkNodes.Reset();
+    Scales.Reset();
+    Costs.Reset();
+
+    const int32 NumNodes = Graph.Num();
+    int32 NumValidNodes = 0;
+    int32 SeedIndex = INDEX_NONE;
+    for (int32 NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex)
+    {
+        if (Graph.IsNodeValid(NodeIndex))
+        {
+            SeedIndex = SeedIndex == INDEX_NONE ? NodeIndex : SeedIndex;
+            ++NumValidNodes;
+        }
+    }
+
+    // Every landmark costs one 16-bit entry per node
+    const int64 LandmarksInBudget = NumNodes > 0 ? MemoryBudgetBytes / (NumNodes * static_cast<int64>(sizeof(uint16))) : 0;
+    const int32 Count = static_cast<int32>(FMath::Min<int64>(FMath::Min(MaxLandmarks, NumValidNodes), LandmarksInBudget));
+    if (Count <= 0)
+    {
+        return;
+    }
+
+    NumLandmarks = Count;
+    LandmarkNodes.SetNumUninitialized(Count);
+    Scales.SetNumUninitialized(Count);
+    Costs.Init(Unreachable, NumNodes * Count);
+
+    FScopedPathfindingSearchContext Context;
+    TArray<int32> LandmarkCosts;
+
+    // The node farthest from an arbitrary seed lies on the rim of the wall, a good first landmark
+    ComputeCosts(Graph, SeedIndex, *Context, LandmarkCosts);
+    int32 NextLandmark = FindFarthestNode(Graph, LandmarkCosts);
+    if (NextLandmark == INDEX_NONE)
+    {
+        NextLandmark = SeedIndex;
+    }
+
+    // Cost of every node to its nearest landmark so far. Nodes no landmark reaches stay at MAX_int32, so other islands get a landmark first
+    TArray<int32> NearestLandmarkCosts;
+    NearestLandmarkCosts.Init(MAX_int32, NumNodes);
+
+    for (int32 Landmark = 0; Landmark < Count; ++Landmark)
+    {
+        LandmarkNodes[Landmark] = NextLandmark;
+        ComputeCosts(Graph, NextLandmark, *Context, LandmarkCosts);
+        StoreCosts(Graph, Landmark, LandmarkCosts);
+
+        for (int32 NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex)
+        {
+            NearestLandmarkCosts[NodeIndex] = FMath::Min(NearestLandmarkCosts[NodeIndex], LandmarkCosts[NodeIndex]);
+        }
+
+        // Landmarks sit at zero, so while there are more valid nodes than landmarks a farthest node exists
+        NextLandmark = FindFarthestNode(Graph, NearestLandmarkCosts);
+    }
+}
+
+// Brings the cost tables of the current landmarks back to a lower bound after FreedNodes became valid on a changed graph
+void FPathfindingLandmarks::Repair(const FPathfindingGraph& Graph, const TArray<int32>& FreedNodes)
+{
+    if (NumLandmarks == 0)
+    {
+        return;
+    }
+
+    // Appended nodes start invalid. The ones that are already valid are among the freed nodes
+    Costs.SetNum(Graph.Num() * NumLandmarks, Unreachable);
+    if (FreedNodes.Num() == 0)
+    {
+        return;
+    }
+
+    // Costs stored for a node while it was blocked, or before, no longer hold once it is back
+    TArray<int32> SeedNodes;
+    for (const int32 FreedIndex : FreedNodes)
+    {
+        for (int32 Landmark = 0; Landmark < NumLandmarks; ++Landmark)
+        {
+            Costs.GetMutable(FreedIndex * NumLandmarks + Landmark) = Unreachable;
+        }
+
+        // A freed node also opens the diagonal moves between its neighbors that it used to block
+        SeedNodes.AddUnique(FreedIndex);
+        const FIntPoint FreedID = Graph.NodeIDs[FreedIndex];
+        for (const FIntPoint& Offset : FPathfindingJumpTable::Directions)
+        {
+            const int32 NeighborIndex = Graph.FindValidNode(FreedID + Offset);
+            if (NeighborIndex != INDEX_NONE)
+            {
+                SeedNodes.AddUnique(NeighborIndex);
+            }
+        }
+    }
+
+    // Landmarks only read the table while they repair in parallel. Their costs share pages, so the writes are applied afterwards
+    TArray<TArray<TPair<int32, uint16>>> RepairedCosts;
+    TArray<TArray<int32>> RecomputedCosts;
+    RepairedCosts.SetNum(NumLandmarks);
+    RecomputedCosts.SetNum(NumLandmarks);
+    ParallelFor(NumLandmarks, [this, &Graph, &SeedNodes, &RepairedCosts, &RecomputedCosts](int32 Landmark)
+    {
+        FScopedPathfindingSearchContext Context;
+        if (!RepairCosts(Graph, Landmark, SeedNodes, *Context, RepairedCosts[Landmark]))
+        {
+            ComputeCosts(Graph, LandmarkNodes[Landmark], *Context, RecomputedCosts[Landmark]);
+        }
+    });
+
+    for (int32 Landmark = 0; Landmark < NumLandmarks; ++Landmark)
+    {
+        if (RecomputedCosts[Landmark].Num() > 0)
+        {
+            StoreCosts(Graph, Landmark, RecomputedCosts[Landmark]);
+            continue;
+        }
+
+        for (const TPair<int32, uint16>& Repaired : RepairedCosts[Landmark])
+        {
+            Costs.GetMutable(Repaired.Key * NumLandmarks + Landmark) = Repaired.Value;
+        }
+    }
+}
+
+// Repairs the column of one landmark around the freed nodes
+bool FPathfindingLandmarks::RepairCosts(const FPathfindingGraph& Graph, int32 Landmark, const TArray<int32>& SeedNodes, FPathfindingSearchContext& Context, TArray<TPair<int32, uint16>>& OutRepairedCosts) const
+{
+    // A stored step covers the true costs from Step * Scale to Step * Scale + Scale - 1. Untouched nodes are read at the bottom of
+    // their step when they bound a repaired cost from above, and at the top when deciding whether a repaired neighbor forces them
+    // to drop. That keeps the costs a lower bound for any scale. With a scale of one it is exactly the decrease-only Dijkstra
+    const int32 Scale = Scales[Landmark];
+    auto GetStoredLow = [this, Landmark, Scale](int32 NodeIndex)
+    {
+        const uint16 Stored = Costs[NodeIndex * NumLandmarks + Landmark];
+        return Stored != Unreachable ? Stored * Scale : MAX_int32;
+    };
+    auto GetStoredHigh = [this, Landmark, Scale](int32 NodeIndex)
+    {
+        const uint16 Stored = Costs[NodeIndex * NumLandmarks + Landmark];
+        return Stored != Unreachable ? Stored * Scale + Scale - 1 : MAX_int32;
+    };
+
+    // Repaired nodes hold their new cost in the context. The rest still hold their stored cost
+    Context.BeginQuery(Graph.Num());
+    FPathfindingOpenSet& OpenSet = Context.GetOpenSet();
+    TArray<int32> RepairedNodes;
+
+    // Lowers a node to Cost if that is below what it holds. A node repaired for the first time also takes the bound of its
+    // untouched neighbors, so its cost stays within one move of each of them
+    auto Lower = [&Graph, &Context, &OpenSet, &RepairedNodes, &GetStoredLow, &GetStoredHigh](int32 NodeIndex, int32 Cost)
+    {
+        const bool bRepaired = Context.IsVisited(NodeIndex);
+        if (!bRepaired)
+        {
+            const FIntPoint NodeID = Graph.NodeIDs[NodeIndex];
+            for (uint32 Moves = Graph.NeighborMasks[NodeIndex]; Moves != 0; Moves &= Moves - 1)
+            {
+                const int32 Direction = FMath::CountTrailingZeros(Moves);
+                const int32 NeighborIndex = Graph.GetNeighbor(NodeID, Direction);
+                const int32 NeighborCost = Context.IsVisited(NeighborIndex) ? Context.GetGCost(NeighborIndex) : GetStoredLow(NeighborIndex);
+                if (NeighborCost != MAX_int32)
+                {
+                    Cost = FMath::Min(Cost, NeighborCost + FPathfindingGraph::GetMovementCost(FPathfindingJumpTable::Directions[Direction]));
+                }
+            }
+        }
+
+        if (Cost < (bRepaired ? Context.GetGCost(NodeIndex) : GetStoredHigh(NodeIndex)))
+        {
+            if (!bRepaired)
+            {
+                RepairedNodes.Add(NodeIndex);
+            }
+            Context.SetNode(NodeIndex, Cost, INDEX_NONE);
+            OpenSet.Push(NodeIndex, Cost, 0);
+        }
+    };
+
+    for (const int32 SeedIndex : SeedNodes)
+    {
+        Lower(SeedIndex, MAX_int32);
+    }
+
+    // A node can be lowered again after it was expanded, so it is simply queued again. Costs only drop, so this ends
+    while (!OpenSet.IsEmpty())
+    {
+        const int32 CurrentIndex = OpenSet.Pop();
+        const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+        const int32 CurrentCost = Context.GetGCost(CurrentIndex);
+
+        for (uint32 Moves = Graph.NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+        {
+            const int32 Direction = FMath::CountTrailingZeros(Moves);
+            Lower(Graph.GetNeighbor(CurrentID, Direction), CurrentCost + FPathfindingGraph::GetMovementCost(FPathfindingJumpTable::Directions[Direction]));
+        }
+    }
+
+    // A node newly connected to the landmark can lie farther than the scale was chosen for
+    for (const int32 NodeIndex : RepairedNodes)
+    {
+        if (Context.GetGCost(NodeIndex) / Scale >= Unreachable)
+        {
+            return false;
+        }
+    }
+
+    OutRepairedCosts.Reset(RepairedNodes.Num());
+    for (const int32 NodeIndex : RepairedNodes)
+    {
+        OutRepairedCosts.Emplace(NodeIndex, static_cast<uint16>(Context.GetGCost(NodeIndex) / Scale));
+    }
+    return true;
+}
+
+// Writes the quantized costs from one landmark into its column of the table
+void FPathfindingLandmarks::StoreCosts(const FPathfindingGraph& Graph, int32 Landmark, const TArray<int32>& LandmarkCosts)
+{
+    int32 MaxCost = 0;
+    for (const int32 Cost : LandmarkCosts)
+    {
+        if (Cost != MAX_int32)
+        {
+            MaxCost = FMath::Max(MaxCost, Cost);
+        }
+    }
+
+    // Costs are stored rounded down in steps of Scale, with the top value reserved for unreachable nodes
+    const int32 Scale = FMath::Max(1, FMath::DivideAndRoundUp(MaxCost, Unreachable - 1));
+    Scales[Landmark] = Scale;
+
+    for (int32 NodeIndex = 0; NodeIndex < Graph.Num(); ++NodeIndex)
+    {
+        const int32 Cost = LandmarkCosts[NodeIndex];
+        Costs.GetMutable(NodeIndex * NumLandmarks + Landmark) = Cost != MAX_int32 ? static_cast<uint16>(Cost / Scale) : Unreachable;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+    PathfindingLandmarks.h
+    Purpose: Header file for the ALT (A*, Landmarks, Triangle inequality) heuristic.
+    A few landmark nodes are picked far apart from each other and the travel cost from each landmark to every node is stored.
+    Since d(L, To) <= d(L, From) + d(From, To), the difference of two stored costs bounds the cost between any two nodes from below,
+    which is much tighter than a geometric estimate around obstacles.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationPagedArray.h"
+
+struct FPathfindingGraph;
+class FPathfindingSearchContext;
+
+// Per-node travel costs to a set of landmarks
+struct WALLCLIMBER_ANDRE_API FPathfindingLandmarks
+{
+public:
+    // Stored cost of nodes a landmark cannot reach
+    static constexpr uint16 Unreachable = MAX_uint16;
+
+    // Picks up to MaxLandmarks landmarks that fit in MemoryBudgetBytes and computes their cost tables
+    // Landmarks are chosen by farthest-point sampling: each one is the node farthest from the landmarks picked before it
+    void Build(const FPathfindingGraph& Graph, int32 MaxLandmarks, int64 MemoryBudgetBytes);
+
+    // Brings the cost tables of the current landmarks back to a lower bound after FreedNodes became valid on a changed graph
+    // Freed nodes open new moves, so costs can only drop. Each landmark runs a decrease-only Dijkstra seeded at the freed nodes and
+    // their neighbors, which stops wherever the costs no longer drop: the repair visits the area the freed nodes open up, not the grid
+    // Nodes the graph appended since the build are added as unreachable first
+    void Repair(const FPathfindingGraph& Graph, const TArray<int32>& FreedNodes);
+
+    // Lower bound of the cost between two nodes, zero if no landmark reaches both
+    int32 GetHeuristic(int32 FromIndex, int32 ToIndex) const
+    {
+        int32 Bound = 0;
+        for (int32 Landmark = 0; Landmark < NumLandmarks; ++Landmark)
+        {
+            const uint16 FromCost = Costs[FromIndex * NumLandmarks + Landmark];
+            const uint16 ToCost = Costs[ToIndex * NumLandmarks + Landmark];
+            if (FromCost != Unreachable && ToCost != Unreachable)
+            {
+                // A stored step of Scale covers true costs up to Scale - 1 apart, so subtract that slack to stay a lower bound
+                const int32 Steps = FMath::Abs(FromCost - ToCost);
+                Bound = FMath::Max(Bound, Steps * Scales[Landmark] - (Scales[Landmark] - 1));
+            }
+        }
+        return Bound;
+    }
+
+    int32 Num() const { return NumLandmarks; }
+
+    // Whether the cost tables cover a graph of NumNodes nodes
+    bool IsBuiltFor(int32 NumNodes) const { return Costs.Num() == NumNodes * NumLandmarks; }
+
+    // Graph index of a landmark
+    int32 GetLandmarkNode(int32 Landmark) const { return LandmarkNodes[Landmark]; }
+
+    // Memory held by the cost tables, in bytes
+    int64 GetAllocatedSize() const { return Costs.GetAllocatedSize() + LandmarkNodes.GetAllocatedSize() + Scales.GetAllocatedSize(); }
+
+private:
+    // Writes the quantized costs from one landmark into its column of the table
+    void StoreCosts(const FPathfindingGraph& Graph, int32 Landmark, const TArray<int32>& LandmarkCosts);
+
+    // Repairs the column of one landmark around the freed nodes into OutRepairedCosts, leaving the table untouched
+    // False if a repaired cost no longer fits the landmark's scale
+    bool RepairCosts(const FPathfindingGraph& Graph, int32 Landmark, const TArray<int32>& SeedNodes, FPathfindingSearchContext& Context, TArray<TPair<int32, uint16>>& OutRepairedCosts) const;
+
+    int32 NumLandmarks = 0;
+    TArray<int32> LandmarkNodes;
+
+    // Cost units per stored step of each landmark, chosen so its farthest node still fits in 16 bits
+    TArray<int32> Scales;
+
+    // Node-major table: the costs of node N to every landmark sit together at N * NumLandmarks
+    // Shares its pages with the tables of earlier graph versions until a repair writes to them
+    TNavigationPagedArray<uint16> Costs;
+};
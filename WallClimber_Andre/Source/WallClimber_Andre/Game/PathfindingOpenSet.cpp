@@ -0,0 +1,147 @@
+/*
+    PathfindingOpenSet.cpp
+    Purpose: Implementation of the indexed binary min-heap used as the A* open set.
+*/
+
+#include "PathfindingOpenSet.h"
+
+// Sizes the node-to-slot lookup for a graph of NumNodes nodes and empties the heap
+void FPathfindingOpenSet::Initialize(int32 NumNodes)
+{
+    Heap.Reset();
+    HeapSlots.Init(INDEX_NONE, NumNodes);
+}
+
+// Extends the node-to-slot lookup to a graph grown to NumNodes nodes, keeping the queued nodes
+void FPathfindingOpenSet::Grow(int32 NumNodes)
+{
+    HeapSlots.Reserve(NumNodes);
+    while (HeapSlots.Num() < NumNodes)
+    {
+        HeapSlots.Add(INDEX_NONE);
+    }
+}
+
+// Empties the heap, only touching the nodes that are still queued
+void FPathfindingOpenSet::Reset()
+{
+    for (const FEntry& Entry : Heap)
+    {
+        HeapSlots[Entry.NodeIndex] = INDEX_NONE;
+    }
+    Heap.Reset();
+}
+
+// Queues the node, or moves it to its new place if it is already queued (decrease-key)
+void FPathfindingOpenSet::Push(int32 NodeIndex, int32 FCost, int32 HCost)
+{
+    check(HeapSlots.IsValidIndex(NodeIndex));
+
+    const FEntry Entry = { NodeIndex, FCost, HCost };
+    int32 Slot = HeapSlots[NodeIndex];
+
+    if (Slot == INDEX_NONE)
+    {
+        Slot = Heap.AddUninitialized();
+        Place(Slot, Entry);
+        SiftUp(Slot);
+    }
+    else
+    {
+        // The key may move either way, so restore the heap in both directions
+        Place(Slot, Entry);
+        SiftUp(Slot);
+        SiftDown(HeapSlots[NodeIndex]);
+    }
+}
+
+// Removes and returns the node with the lowest FCost, preferring the lowest HCost on ties
+int32 FPathfindingOpenSet::Pop()
+{
+    check(Heap.Num() > 0);
+
+    const int32 TopNode = Heap[0].NodeIndex;
+    HeapSlots[TopNode] = INDEX_NONE;
+
+    const FEntry Last = Heap.Pop(false);
+    if (Heap.Num() > 0)
+    {
+        Place(0, Last);
+        SiftDown(0);
+    }
+
+    return TopNode;
+}
+
+// Takes the node out of the heap if it is queued
+void FPathfindingOpenSet::Remove(int32 NodeIndex)
+{
+    if (!Contains(NodeIndex))
+    {
+        return;
+    }
+
+    const int32 Slot = HeapSlots[NodeIndex];
+    HeapSlots[NodeIndex] = INDEX_NONE;
+
+    // Fill the hole with the last entry, which may belong above or below it
+    const FEntry Last = Heap.Pop(false);
+    if (Slot < Heap.Num())
+    {
+        Place(Slot, Last);
+        SiftUp(Slot);
+        SiftDown(HeapSlots[Last.NodeIndex]);
+    }
+}
+
+// Moves the entry at Slot towards the root until its parent is not larger
+void FPathfindingOpenSet::SiftUp(int32 Slot)
+{
+    const FEntry Entry = Heap[Slot];
+
+    while (Slot > 0)
+    {
+        const int32 ParentSlot = (Slot - 1) / 2;
+        if (!IsLess(Entry, Heap[ParentSlot]))
+        {
+            break;
+        }
+
+        Place(Slot, Heap[ParentSlot]);
+        Slot = ParentSlot;
+    }
+
+    Place(Slot, Entry);
+}
+
+// Moves the entry at Slot towards the leaves until no child is smaller
+void FPathfindingOpenSet::SiftDown(int32 Slot)
+{
+    const FEntry Entry = Heap[Slot];
+    const int32 Count = Heap.Num();
+
+    while (true)
+    {
+        int32 ChildSlot = Slot * 2 + 1;
+        if (ChildSlot >= Count)
+        {
+            break;
+        }
+
+        // Pick the smaller of the two children
+        if (ChildSlot + 1 < Count && IsLess(Heap[ChildSlot + 1], Heap[ChildSlot]))
+        {
+            ++ChildSlot;
+        }
+
+        if (!IsLess(Heap[ChildSlot], Entry))
+        {
+            break;
+        }
+
+        Place(Slot, Heap[ChildSlot]);
+        Slot = ChildSlot;
+    }
+
+    Place(Slot, Entry);
+}
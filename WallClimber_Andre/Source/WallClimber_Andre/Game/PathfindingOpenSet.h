@@ -0,0 +1,80 @@
+/*
+    PathfindingOpenSet.h
+    Purpose: Header file for the open set used by the A* search. It is an indexed binary min-heap keyed on FCost with HCost as tie-breaker.
+    Every node remembers its slot in the heap, so membership tests are O(1) and push, pop and decrease-key are O(log n).
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Indexed min-heap of pathfinding node indices
+struct WALLCLIMBER_ANDRE_API FPathfindingOpenSet
+{
+public:
+    // Sizes the node-to-slot lookup for a graph of NumNodes nodes and empties the heap
+    void Initialize(int32 NumNodes);
+
+    // Extends the node-to-slot lookup to a graph grown to NumNodes nodes, keeping the queued nodes
+    void Grow(int32 NumNodes);
+
+    // Empties the heap, only touching the nodes that are still queued
+    void Reset();
+
+    // Whether there are nodes left to evaluate
+    bool IsEmpty() const { return Heap.Num() == 0; }
+
+    // Number of queued nodes
+    int32 Num() const { return Heap.Num(); }
+
+    // Whether the node is currently queued
+    bool Contains(int32 NodeIndex) const { return HeapSlots.IsValidIndex(NodeIndex) && HeapSlots[NodeIndex] != INDEX_NONE; }
+
+    // Queues the node, or moves it to its new place if it is already queued (decrease-key)
+    void Push(int32 NodeIndex, int32 FCost, int32 HCost);
+
+    // Removes and returns the node with the lowest FCost, preferring the lowest HCost on ties
+    int32 Pop();
+
+    // Takes the node out of the heap if it is queued
+    void Remove(int32 NodeIndex);
+
+    // Lowest FCost in the heap. The heap must not be empty
+    int32 GetMinFCost() const { return Heap[0].FCost; }
+
+    // HCost of the entry with the lowest FCost. The heap must not be empty
+    int32 GetMinHCost() const { return Heap[0].HCost; }
+
+    // Node with the lowest FCost, left in the heap. The heap must not be empty
+    int32 Top() const { return Heap[0].NodeIndex; }
+
+private:
+    struct FEntry
+    {
+        int32 NodeIndex;
+        int32 FCost;
+        int32 HCost;
+    };
+
+    // Heap ordering: lower FCost first, then lower HCost (closer to the goal)
+    static bool IsLess(const FEntry& A, const FEntry& B)
+    {
+        return A.FCost < B.FCost || (A.FCost == B.FCost && A.HCost < B.HCost);
+    }
+
+    void SiftUp(int32 Slot);
+    void SiftDown(int32 Slot);
+
+    // Writes the entry to a heap slot and records the slot for its node
+    void Place(int32 Slot, const FEntry& Entry)
+    {
+        Heap[Slot] = Entry;
+        HeapSlots[Entry.NodeIndex] = Slot;
+    }
+
+    // Binary heap storage
+    TArray<FEntry> Heap;
+
+    // Heap slot of each node, INDEX_NONE when the node is not queued
+    TArray<int32> HeapSlots;
+};
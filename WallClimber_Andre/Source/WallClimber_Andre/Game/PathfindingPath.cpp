@@ -0,0 +1,66 @@
+/*
+    PathfindingPath.cpp
+    Purpose: Implementation of the compact path result and its buffer pool.
+*/
+
+#include "PathfindingPath.h"
+#include "Misc/ScopeLock.h"
+
+FPathfindingPath& FPathfindingPath::operator=(FPathfindingPath&& Other)
+{
+    if (this != &Other)
+    {
+        Reset();
+        Graph = MoveTemp(Other.Graph);
+        NodeIndices = MoveTemp(Other.NodeIndices);
+    }
+    return *this;
+}
+
+// Starts an empty path on InGraph, keeping the current buffer or taking one from the pool
+void FPathfindingPath::Initialize(const FPathfindingGraphPtr& InGraph)
+{
+    Graph = InGraph;
+    if (NodeIndices.Max() == 0)
+    {
+        NodeIndices = FPathfindingPathBufferPool::Get().Acquire();
+    }
+    NodeIndices.Reset();
+}
+
+// Empties the path and hands its buffer back to the pool
+void FPathfindingPath::Reset()
+{
+    if (NodeIndices.Max() > 0)
+    {
+        FPathfindingPathBufferPool::Get().Release(MoveTemp(NodeIndices));
+        NodeIndices.Empty();
+    }
+    Graph.Reset();
+}
+
+// Pool shared by every path
+FPathfindingPathBufferPool& FPathfindingPathBufferPool::Get()
+{
+    static FPathfindingPathBufferPool Pool;
+    return Pool;
+}
+
+// Takes an empty buffer from the pool, or a new one if none is free
+TArray<int32> FPathfindingPathBufferPool::Acquire()
+{
+    FScopeLock Lock(&Mutex);
+    return FreeBuffers.Num() > 0 ? FreeBuffers.Pop(false) : TArray<int32>();
+}
+
+// Returns a buffer to the pool
+void FPathfindingPathBufferPool::Release(TArray<int32>&& Buffer)
+{
+    Buffer.Reset();
+
+    FScopeLock Lock(&Mutex);
+    if (FreeBuffers.Num() < MaxFreeBuffers)
+    {
+        FreeBuffers.Add(MoveTemp(Buffer));
+    }
+}
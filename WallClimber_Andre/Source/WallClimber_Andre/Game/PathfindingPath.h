@@ -0,0 +1,77 @@
+/*
+    PathfindingPath.h
+    Purpose: Header file for the compact path result handed from the searches to the agents that follow them.
+    A path is the list of node indices on the graph it was found on, instead of a full FPathfindingNode per step.
+    Its buffer comes from a shared pool and goes back to it when the path is reset or destroyed, and paths can only be moved,
+    so once the pool is warm a query allocates nothing on its way from the search through the controller into the character.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "PathfindingGraph.h"
+
+// Node indices of a path, together with the graph they index into
+class WALLCLIMBER_ANDRE_API FPathfindingPath
+{
+public:
+    FPathfindingPath() = default;
+    ~FPathfindingPath() { Reset(); }
+
+    FPathfindingPath(FPathfindingPath&& Other) = default;
+    FPathfindingPath& operator=(FPathfindingPath&& Other);
+
+    // Paths own a pooled buffer, copies would defeat the pool
+    FPathfindingPath(const FPathfindingPath&) = delete;
+    FPathfindingPath& operator=(const FPathfindingPath&) = delete;
+
+    // Starts an empty path on InGraph, keeping the current buffer or taking one from the pool
+    void Initialize(const FPathfindingGraphPtr& InGraph);
+
+    // Empties the path and hands its buffer back to the pool
+    void Reset();
+
+    int32 Num() const { return NodeIndices.Num(); }
+    bool IsEmpty() const { return NodeIndices.Num() == 0; }
+
+    // Graph index of a waypoint
+    int32 GetNodeIndex(int32 Waypoint) const { return NodeIndices[Waypoint]; }
+
+    // World location of a waypoint
+    const FVector& GetLocation(int32 Waypoint) const { return Graph->NodeLocations[NodeIndices[Waypoint]]; }
+
+    const FPathfindingGraphPtr& GetGraph() const { return Graph; }
+
+    // Buffer the searches write the node indices into
+    TArray<int32>& GetNodeIndices() { return NodeIndices; }
+    const TArray<int32>& GetNodeIndices() const { return NodeIndices; }
+
+    // Expands the path into full path nodes with their costs. Allocates, meant for callers that need the costs
+    TArray<FPathfindingNode> ToPathNodes() const { return Graph ? Graph->MakePath(NodeIndices) : TArray<FPathfindingNode>(); }
+
+private:
+    FPathfindingGraphPtr Graph;
+    TArray<int32> NodeIndices;
+};
+
+// Thread-safe pool of path buffers, shared by every search that produces an FPathfindingPath
+class WALLCLIMBER_ANDRE_API FPathfindingPathBufferPool
+{
+public:
+    // Pool shared by every path
+    static FPathfindingPathBufferPool& Get();
+
+    // Takes an empty buffer from the pool, or a new one if none is free
+    TArray<int32> Acquire();
+
+    // Returns a buffer to the pool. Buffers beyond the pool's capacity are freed
+    void Release(TArray<int32>&& Buffer);
+
+private:
+    // More buffers than agents with a path in flight are never needed at once
+    static constexpr int32 MaxFreeBuffers = 256;
+
+    FCriticalSection Mutex;
+    TArray<TArray<int32>> FreeBuffers;
+};
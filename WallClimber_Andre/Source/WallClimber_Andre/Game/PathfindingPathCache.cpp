@@ -0,0 +1,276 @@
+/*
+    PathfindingPathCache.cpp
+    Purpose: Implementation of the LRU path cache.
+*/
+
+#include "PathfindingPathCache.h"
+#include "Misc/ScopeLock.h"
+
+// Maximum number of paths kept
+void FPathfindingPathCache::SetCapacity(int32 InCapacity)
+{
+    const int32 Capacity = FMath::Max(InCapacity, 0);
+    const int32 NewNumShards = FMath::Clamp(Capacity / MinShardCapacity, 1, MaxShards);
+
+    // Paths would land in other shards than the ones holding them
+    if (NewNumShards != NumShards)
+    {
+        for (FShard& Shard : Shards)
+        {
+            Shard.Empty();
+        }
+        NumShards = NewNumShards;
+    }
+
+    for (int32 ShardIndex = 0; ShardIndex < NumShards; ++ShardIndex)
+    {
+        Shards[ShardIndex].SetCapacity(Capacity / NumShards + (ShardIndex < Capacity % NumShards ? 1 : 0));
+    }
+}
+
+// Writes the cached path from StartIndex to EndIndex into OutPath
+bool FPathfindingPathCache::Find(int32 StartIndex, int32 EndIndex, uint8 SearchMode, uint32 NavigationVersion, TArray<int32>& OutPath)
+{
+    const FKey Key{ StartIndex, EndIndex, SearchMode };
+    return GetShard(Key).Find(Key, NavigationVersion, OutPath);
+}
+
+// Caches a path found on a graph of the given navigation version
+void FPathfindingPathCache::Add(int32 StartIndex, int32 EndIndex, uint8 SearchMode, uint32 NavigationVersion, const TArray<int32>& Path)
+{
+    const FKey Key{ StartIndex, EndIndex, SearchMode };
+    GetShard(Key).Add(Key, NavigationVersion, Path);
+}
+
+// Drops every cached path. Counters are kept
+void FPathfindingPathCache::Empty()
+{
+    for (FShard& Shard : Shards)
+    {
+        Shard.Empty();
+    }
+}
+
+// Snapshot of the counters
+FPathCacheStats FPathfindingPathCache::GetStats() const
+{
+    FPathCacheStats Snapshot;
+    for (const FShard& Shard : Shards)
+    {
+        Shard.AddStats(Snapshot);
+    }
+    return Snapshot;
+}
+
+// Maximum number of paths the shard keeps
+void FPathfindingPathCache::FShard::SetCapacity(int32 InCapacity)
+{
+    FScopeLock Lock(&Mutex);
+    Capacity = InCapacity;
+    while (SlotByKey.Num() > Capacity)
+    {
+        Evict(OldestSlot);
+    }
+
+    // No more than Capacity slots are ever in use again, so the buffers of the free slots beyond that go
+    int32 NumBufferedSlots = Entries.Num();
+    for (int32 FreeIndex = 0; FreeIndex < FreeSlots.Num() && NumBufferedSlots > Capacity; ++FreeIndex, --NumBufferedSlots)
+    {
+        FEntry& Entry = Entries[FreeSlots[FreeIndex]];
+        PathBytes -= Entry.Path.GetAllocatedSize();
+        Entry.Path.Empty();
+    }
+}
+
+// Writes the cached path of the key into OutPath, or the tail of a cached path to the same goal through the start node
+bool FPathfindingPathCache::FShard::Find(const FKey& Key, uint32 NavigationVersion, TArray<int32>& OutPath)
+{
+    FScopeLock Lock(&Mutex);
+
+    if (NavigationVersion == CachedVersion)
+    {
+        if (const int32* Slot = SlotByKey.Find(Key))
+        {
+            OutPath = Entries[*Slot].Path;
+            Touch(*Slot);
+            ++Stats.Hits;
+            return true;
+        }
+
+        // A path through the start node to the same goal contains the answer from the start node onwards
+        if (const FSubpathPosition* Subpath = SubpathByNode.Find(FSubpathKey{ Key.StartIndex, Key.GetGoalKey() }))
+        {
+            const TArray<int32>& CachedPath = Entries[Subpath->Slot].Path;
+            OutPath.Reset();
+            OutPath.Append(CachedPath.GetData() + Subpath->Position, CachedPath.Num() - Subpath->Position);
+            Touch(Subpath->Slot);
+            ++Stats.SubpathHits;
+            return true;
+        }
+    }
+
+    ++Stats.Misses;
+    return false;
+}
+
+// Caches a path found on a graph of the given navigation version
+void FPathfindingPathCache::FShard::Add(const FKey& Key, uint32 NavigationVersion, const TArray<int32>& Path)
+{
+    FScopeLock Lock(&Mutex);
+
+    // Versions only grow, a result from an older graph is already stale
+    if (NavigationVersion < CachedVersion || Capacity == 0)
+    {
+        return;
+    }
+    if (NavigationVersion > CachedVersion)
+    {
+        EmptyLocked();
+        CachedVersion = NavigationVersion;
+    }
+
+    if (const int32* ExistingSlot = SlotByKey.Find(Key))
+    {
+        Touch(*ExistingSlot);
+        return;
+    }
+
+    if (SlotByKey.Num() >= Capacity)
+    {
+        Evict(OldestSlot);
+    }
+
+    // A reused slot copies into the buffer of the path evicted from it, which only grows for a longer path
+    const int32 Slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(false) : Entries.AddDefaulted();
+    FEntry& Entry = Entries[Slot];
+    Entry.Key = Key;
+    PathBytes -= Entry.Path.GetAllocatedSize();
+    Entry.Path.Reset();
+    Entry.Path.Append(Path);
+    PathBytes += Entry.Path.GetAllocatedSize();
+
+    SlotByKey.Add(Key, Slot);
+    const uint64 GoalKey = Key.GetGoalKey();
+    for (int32 Position = 0; Position < Path.Num(); ++Position)
+    {
+        SubpathByNode.FindOrAdd(FSubpathKey{ Path[Position], GoalKey }, FSubpathPosition{ Slot, Position });
+    }
+    Touch(Slot);
+}
+
+// Drops every cached path of the shard. Counters are kept
+void FPathfindingPathCache::FShard::Empty()
+{
+    FScopeLock Lock(&Mutex);
+    EmptyLocked();
+}
+
+// Adds the shard's counters to OutStats
+void FPathfindingPathCache::FShard::AddStats(FPathCacheStats& OutStats) const
+{
+    FScopeLock Lock(&Mutex);
+
+    OutStats.Hits += Stats.Hits;
+    OutStats.SubpathHits += Stats.SubpathHits;
+    OutStats.Misses += Stats.Misses;
+    OutStats.Evictions += Stats.Evictions;
+    OutStats.NumEntries += SlotByKey.Num();
+    OutStats.MemoryBytes += PathBytes + Entries.GetAllocatedSize() + FreeSlots.GetAllocatedSize() + SlotByKey.GetAllocatedSize() + SubpathByNode.GetAllocatedSize();
+}
+
+// Moves an entry to the most recently used end of the list
+void FPathfindingPathCache::FShard::Touch(int32 Slot)
+{
+    if (Slot == NewestSlot)
+    {
+        return;
+    }
+
+    Unlink(Slot);
+
+    FEntry& Entry = Entries[Slot];
+    Entry.Older = NewestSlot;
+    Entry.Newer = INDEX_NONE;
+    if (NewestSlot != INDEX_NONE)
+    {
+        Entries[NewestSlot].Newer = Slot;
+    }
+    NewestSlot = Slot;
+    if (OldestSlot == INDEX_NONE)
+    {
+        OldestSlot = Slot;
+    }
+}
+
+// Takes an entry out of the recency list
+void FPathfindingPathCache::FShard::Unlink(int32 Slot)
+{
+    FEntry& Entry = Entries[Slot];
+    if (Entry.Newer != INDEX_NONE)
+    {
+        Entries[Entry.Newer].Older = Entry.Older;
+    }
+    else if (NewestSlot == Slot)
+    {
+        NewestSlot = Entry.Older;
+    }
+
+    if (Entry.Older != INDEX_NONE)
+    {
+        Entries[Entry.Older].Newer = Entry.Newer;
+    }
+    else if (OldestSlot == Slot)
+    {
+        OldestSlot = Entry.Newer;
+    }
+
+    Entry.Newer = INDEX_NONE;
+    Entry.Older = INDEX_NONE;
+}
+
+// Removes an entry and frees its slot. The path buffer stays with the slot
+void FPathfindingPathCache::FShard::Evict(int32 Slot)
+{
+    if (Slot == INDEX_NONE)
+    {
+        return;
+    }
+
+    FEntry& Entry = Entries[Slot];
+    Unlink(Slot);
+    SlotByKey.Remove(Entry.Key);
+
+    // Nodes another path to the goal also passes through lose their subpath answer until a path through them is cached again
+    const uint64 GoalKey = Entry.Key.GetGoalKey();
+    for (const int32 NodeIndex : Entry.Path)
+    {
+        const FSubpathKey SubpathKey{ NodeIndex, GoalKey };
+        const FSubpathPosition* Subpath = SubpathByNode.Find(SubpathKey);
+        if (Subpath && Subpath->Slot == Slot)
+        {
+            SubpathByNode.Remove(SubpathKey);
+        }
+    }
+
+    Entry.Path.Reset();
+    FreeSlots.Add(Slot);
+    ++Stats.Evictions;
+}
+
+// Drops every cached path without taking the lock. Slots and their path buffers are kept for the paths cached next
+void FPathfindingPathCache::FShard::EmptyLocked()
+{
+    FreeSlots.Reset();
+    for (int32 Slot = Entries.Num() - 1; Slot >= 0; --Slot)
+    {
+        FEntry& Entry = Entries[Slot];
+        Entry.Path.Reset();
+        Entry.Newer = INDEX_NONE;
+        Entry.Older = INDEX_NONE;
+        FreeSlots.Add(Slot);
+    }
+    SlotByKey.Reset();
+    SubpathByNode.Reset();
+    NewestSlot = INDEX_NONE;
+    OldestSlot = INDEX_NONE;
+}
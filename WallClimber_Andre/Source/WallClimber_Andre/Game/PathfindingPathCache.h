@@ -0,0 +1,177 @@
+/*
+    PathfindingPathCache.h
+    Purpose: Header file for the LRU cache of recent path results.
+    Entries are keyed on the resolved start and end node indices and tagged with the navigation version of the graph they were searched on,
+    so a rebuild or edit of the NavigationBuilder drops them. A query whose start lies on a cached path to the same goal is answered by slicing that path.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "PathfindingPathCache.generated.h"
+
+// Counters of a path cache
+USTRUCT(BlueprintType)
+struct FPathCacheStats
+{
+    GENERATED_BODY()
+
+    // Queries answered with a cached path as is
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PathCache")
+    int32 Hits = 0;
+
+    // Queries answered by slicing a cached path to the same goal
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PathCache")
+    int32 SubpathHits = 0;
+
+    // Queries that had to be searched
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PathCache")
+    int32 Misses = 0;
+
+    // Entries dropped to make room for newer ones
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PathCache")
+    int32 Evictions = 0;
+
+    // Entries currently cached
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PathCache")
+    int32 NumEntries = 0;
+
+    // Memory held by the cached paths and the cache tables, in bytes
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "PathCache")
+    int64 MemoryBytes = 0;
+
+    // Share of queries answered from the cache, either whole or sliced
+    float GetHitRate() const
+    {
+        const int32 Lookups = Hits + SubpathHits + Misses;
+        return Lookups > 0 ? static_cast<float>(Hits + SubpathHits) / Lookups : 0.f;
+    }
+};
+
+// Thread-safe LRU cache of node index paths, shared by the game thread and the pathfinding workers
+// Paths are split by goal over shards with a lock and an LRU list each, so workers querying different goals rarely wait on each other
+class WALLCLIMBER_ANDRE_API FPathfindingPathCache
+{
+public:
+    // Maximum number of paths kept. Shrinking the capacity evicts the least recently used paths
+    // Large capacities are split evenly over up to MaxShards shards, which changing the number of shards empties
+    void SetCapacity(int32 InCapacity);
+
+    // Writes the cached path from StartIndex to EndIndex into OutPath. Paths cached for another navigation version never match
+    bool Find(int32 StartIndex, int32 EndIndex, uint8 SearchMode, uint32 NavigationVersion, TArray<int32>& OutPath);
+
+    // Caches a path found on a graph of the given navigation version. Paths from a version older than the cache are ignored,
+    // a newer version drops every cached path first
+    void Add(int32 StartIndex, int32 EndIndex, uint8 SearchMode, uint32 NavigationVersion, const TArray<int32>& Path);
+
+    // Drops every cached path. Counters are kept
+    void Empty();
+
+    // Snapshot of the counters
+    FPathCacheStats GetStats() const;
+
+    // Most shards the cache is split over, and the fewest paths a shard holds before the cache is split
+    static constexpr int32 MaxShards = 8;
+    static constexpr int32 MinShardCapacity = 32;
+
+private:
+    struct FKey
+    {
+        int32 StartIndex;
+        int32 EndIndex;
+        uint8 SearchMode;
+
+        bool operator==(const FKey& Other) const
+        {
+            return StartIndex == Other.StartIndex && EndIndex == Other.EndIndex && SearchMode == Other.SearchMode;
+        }
+
+        friend uint32 GetTypeHash(const FKey& Key)
+        {
+            return HashCombine(HashCombine(::GetTypeHash(Key.StartIndex), ::GetTypeHash(Key.EndIndex)), ::GetTypeHash(Key.SearchMode));
+        }
+
+        // Key shared by every path to the same goal
+        uint64 GetGoalKey() const { return (static_cast<uint64>(static_cast<uint32>(EndIndex)) << 8) | SearchMode; }
+    };
+
+    // A node on a cached path toward a goal
+    struct FSubpathKey
+    {
+        int32 NodeIndex;
+        uint64 GoalKey;
+
+        bool operator==(const FSubpathKey& Other) const
+        {
+            return NodeIndex == Other.NodeIndex && GoalKey == Other.GoalKey;
+        }
+
+        friend uint32 GetTypeHash(const FSubpathKey& Key)
+        {
+            return HashCombine(::GetTypeHash(Key.NodeIndex), ::GetTypeHash(Key.GoalKey));
+        }
+    };
+
+    // Slot of a cached path through a node, and the node's position on it
+    struct FSubpathPosition
+    {
+        int32 Slot;
+        int32 Position;
+    };
+
+    // Cached path, linked into the recency list by slot index. Freed slots keep their path buffer for the next path cached in them
+    struct FEntry
+    {
+        FKey Key;
+        TArray<int32> Path;
+        int32 Newer = INDEX_NONE;
+        int32 Older = INDEX_NONE;
+    };
+
+    // Share of the cache with its own lock, LRU list and navigation version. Every path to a goal lands in the same shard
+    struct FShard
+    {
+        bool Find(const FKey& Key, uint32 NavigationVersion, TArray<int32>& OutPath);
+        void Add(const FKey& Key, uint32 NavigationVersion, const TArray<int32>& Path);
+        void SetCapacity(int32 InCapacity);
+        void Empty();
+        void AddStats(FPathCacheStats& OutStats) const;
+
+        // Moves an entry to the most recently used end of the list
+        void Touch(int32 Slot);
+        void Unlink(int32 Slot);
+        void Evict(int32 Slot);
+        void EmptyLocked();
+
+        mutable FCriticalSection Mutex;
+
+        int32 Capacity = 128;
+        uint32 CachedVersion = 0;
+
+        TArray<FEntry> Entries;
+        TArray<int32> FreeSlots;
+        TMap<FKey, int32> SlotByKey;
+
+        // First cached path through each node toward each goal, so a query starting on one is answered without walking the paths
+        TMap<FSubpathKey, FSubpathPosition> SubpathByNode;
+
+        // Most and least recently used slots
+        int32 NewestSlot = INDEX_NONE;
+        int32 OldestSlot = INDEX_NONE;
+
+        int64 PathBytes = 0;
+        FPathCacheStats Stats;
+    };
+
+    // Shard holding the paths toward the key's goal. The goal is hashed with mixing, node indices of nearby goals share their low bits
+    FShard& GetShard(const FKey& Key)
+    {
+        return Shards[HashCombine(::GetTypeHash(Key.EndIndex), ::GetTypeHash(Key.SearchMode)) % static_cast<uint32>(NumShards)];
+    }
+
+    FShard Shards[MaxShards];
+
+    // Shards in use. Only changed by SetCapacity, before the workers share the cache
+    int32 NumShards = 1;
+};
@@ -0,0 +1,210 @@
+/*
+    PathfindingSearch.cpp
+    Purpose: Implementation of the search context and of the A* searches over a FPathfindingGraph.
+*/
+
+#include "PathfindingSearch.h"
+#include "PathfindingGraph.h"
+#include "PathfindingKernels.h"
+#include "Algo/Reverse.h"
+#include "Misc/ScopeLock.h"
+
+// Starts a new query over a graph of NumNodes nodes. Arrays are only reallocated when the graph outgrows them
+void FPathfindingSearchContext::BeginQuery(int32 NumNodes)
+{
+    // Dirty rebuilds append a node now and then, so grow with some headroom instead of reallocating for every new graph version
+    if (VisitStamps.Num() < NumNodes)
+    {
+        const int32 Capacity = NumNodes + NumNodes / 8;
+        VisitStamps.Init(0, Capacity);
+        ClosedStamps.Init(0, Capacity);
+        GCosts.SetNumUninitialized(Capacity);
+        Parents.SetNumUninitialized(Capacity);
+        OpenSet.Initialize(Capacity);
+        Generation = 0;
+    }
+
+    OpenSet.Reset();
+
+    // Stamps start at zero, so on wrap-around clear them once and skip generation zero
+    if (++Generation == 0)
+    {
+        FMemory::Memzero(VisitStamps.GetData(), VisitStamps.Num() * VisitStamps.GetTypeSize());
+        FMemory::Memzero(ClosedStamps.GetData(), ClosedStamps.Num() * ClosedStamps.GetTypeSize());
+        Generation = 1;
+    }
+}
+
+// Follows the parents back from EndIndex and writes the path from the start node to EndIndex
+void FPathfindingSearchContext::BuildPath(int32 EndIndex, TArray<int32>& OutPath) const
+{
+    OutPath.Reset();
+    for (int32 NodeIndex = EndIndex; NodeIndex != INDEX_NONE; NodeIndex = GetParent(NodeIndex))
+    {
+        OutPath.Add(NodeIndex);
+    }
+    Algo::Reverse(OutPath);
+}
+
+// Pool shared by every pathfinding worker
+FPathfindingSearchContextPool& FPathfindingSearchContextPool::Get()
+{
+    static FPathfindingSearchContextPool Pool;
+    return Pool;
+}
+
+// Takes a free context from the pool, or creates one if none is free
+TUniquePtr<FPathfindingSearchContext> FPathfindingSearchContextPool::Acquire()
+{
+    {
+        FScopeLock Lock(&Mutex);
+        if (FreeContexts.Num() > 0)
+        {
+            return FreeContexts.Pop(false);
+        }
+    }
+    return MakeUnique<FPathfindingSearchContext>();
+}
+
+// Returns a context to the pool
+void FPathfindingSearchContextPool::Release(TUniquePtr<FPathfindingSearchContext> Context)
+{
+    if (Context)
+    {
+        Context->SetCancellationFlag(nullptr);
+
+        FScopeLock Lock(&Mutex);
+        FreeContexts.Add(MoveTemp(Context));
+    }
+}
+
+namespace PathfindingSearch
+{
+    bool FindAStarPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath)
+    {
+        // 8-connected moves at the 10/14 costs, ordered by the landmark heuristic
+        return PathfindingKernels::FindPath<PathfindingKernels::FEightConnected, PathfindingKernels::FLandmarkHeuristic, PathfindingKernels::FOctileCost>(
+            Graph, StartIndex, EndIndex, Context, OutPath);
+    }
+
+    bool FindBidirectionalAStarPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath)
+    {
+        OutPath.Reset();
+        if (!Graph.IsValidIndex(StartIndex) || !Graph.IsValidIndex(EndIndex))
+        {
+            return false;
+        }
+
+        // Side 0 searches forward in the caller's context, side 1 backward in a borrowed one
+        FScopedPathfindingSearchContext BackwardContext;
+        FPathfindingSearchContext* Sides[2] = { &Context, &*BackwardContext };
+        const int32 Origins[2] = { StartIndex, EndIndex };
+        const int32 Targets[2] = { EndIndex, StartIndex };
+
+        for (int32 Side = 0; Side < 2; ++Side)
+        {
+            const int32 HCost = Graph.GetHeuristic(Origins[Side], Targets[Side]);
+            Sides[Side]->BeginQuery(Graph.Num());
+            Sides[Side]->SetNode(Origins[Side], 0, INDEX_NONE);
+            Sides[Side]->GetOpenSet().Push(Origins[Side], HCost, HCost);
+        }
+
+        // Cost of the best path found so far and the node where its two halves meet
+        int32 BestCost = StartIndex == EndIndex ? 0 : MAX_int32;
+        int32 MeetingIndex = StartIndex == EndIndex ? StartIndex : INDEX_NONE;
+
+        // Once either side runs dry, every node its origin can reach has been expanded
+        while (!Sides[0]->GetOpenSet().IsEmpty() && !Sides[1]->GetOpenSet().IsEmpty())
+        {
+            if (Context.IsCancelled())
+            {
+                return false;
+            }
+
+            // Any path not found yet passes through a queued node of each side, so it costs at least their lowest FCost
+            if (BestCost <= FMath::Max(Sides[0]->GetOpenSet().GetMinFCost(), Sides[1]->GetOpenSet().GetMinFCost()))
+            {
+                break;
+            }
+
+            // Expand the side with fewer queued nodes, so a side that is boxed in runs dry first
+            const int32 Side = Sides[0]->GetOpenSet().Num() <= Sides[1]->GetOpenSet().Num() ? 0 : 1;
+            FPathfindingSearchContext& SideContext = *Sides[Side];
+            const FPathfindingSearchContext& OtherContext = *Sides[1 - Side];
+            FPathfindingOpenSet& OpenSet = SideContext.GetOpenSet();
+
+            const int32 CurrentIndex = OpenSet.Pop();
+            SideContext.Close(CurrentIndex);
+
+            const FIntPoint CurrentID = Graph.NodeIDs[CurrentIndex];
+            const int32 CurrentGCost = SideContext.GetGCost(CurrentIndex);
+
+            for (uint32 Moves = Graph.NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+            {
+                const int32 Direction = FMath::CountTrailingZeros(Moves);
+                const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+                const int32 NeighborIndex = Graph.GetNeighbor(CurrentID, Direction);
+                if (SideContext.IsClosed(NeighborIndex))
+                {
+                    continue;
+                }
+
+                // Moves are symmetric, so the backward side walks the same edges in reverse
+                const int32 TentativeGScore = CurrentGCost + FPathfindingGraph::GetMovementCost(NeighborOffset);
+                if (TentativeGScore < SideContext.GetGCost(NeighborIndex))
+                {
+                    const int32 HCost = Graph.GetHeuristic(NeighborIndex, Targets[Side]);
+                    SideContext.SetNode(NeighborIndex, TentativeGScore, CurrentIndex);
+                    OpenSet.Push(NeighborIndex, TentativeGScore + HCost, HCost);
+                }
+
+                // The two searches touch, which joins a full path
+                if (OtherContext.IsVisited(NeighborIndex))
+                {
+                    const int32 PathCost = SideContext.GetGCost(NeighborIndex) + OtherContext.GetGCost(NeighborIndex);
+                    if (PathCost < BestCost)
+                    {
+                        BestCost = PathCost;
+                        MeetingIndex = NeighborIndex;
+                    }
+                }
+            }
+        }
+
+        if (MeetingIndex == INDEX_NONE)
+        {
+            return false;
+        }
+
+        // Forward half from the start to the meeting node, then the backward parents on to the end
+        Context.BuildPath(MeetingIndex, OutPath);
+        for (int32 NodeIndex = BackwardContext->GetParent(MeetingIndex); NodeIndex != INDEX_NONE; NodeIndex = BackwardContext->GetParent(NodeIndex))
+        {
+            OutPath.Add(NodeIndex);
+        }
+        return true;
+    }
+
+    // Reduces a grid path to its corner waypoints
+    void StringPullPath(const FPathfindingGraph& Graph, TArray<int32>& InOutPath)
+    {
+        if (InOutPath.Num() <= 2)
+        {
+            return;
+        }
+
+        // The anchor always sees the node before the one being tested, so that node becomes a waypoint when the sight line breaks
+        int32 NumWaypoints = 1;
+        int32 AnchorIndex = InOutPath[0];
+        for (int32 i = 2; i < InOutPath.Num(); ++i)
+        {
+            if (!Graph.HasLineOfSight(AnchorIndex, InOutPath[i]))
+            {
+                AnchorIndex = InOutPath[i - 1];
+                InOutPath[NumWaypoints++] = AnchorIndex;
+            }
+        }
+        InOutPath[NumWaypoints++] = InOutPath.Last();
+        InOutPath.SetNum(NumWaypoints, false);
+    }
+}
@@ -0,0 +1,120 @@
+/*
+    PathfindingSearch.h
+    Purpose: Header file for the search algorithms that run against a FPathfindingGraph, and for the per-query scratch state they use.
+    Searches never write to the graph. Costs, parents and the open set live in a FPathfindingSearchContext owned by the caller,
+    so one context per thread is enough to run queries in parallel.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "PathfindingOpenSet.h"
+#include <atomic>
+
+struct FPathfindingGraph;
+
+// Per-query scratch state of a search
+// Every entry is stamped with the generation of the query that wrote it, so entries from earlier queries read as unvisited
+// and starting a new query does not need an O(N) clear
+class WALLCLIMBER_ANDRE_API FPathfindingSearchContext
+{
+public:
+    // Starts a new query over a graph of NumNodes nodes. Arrays are only reallocated when the graph outgrows them
+    void BeginQuery(int32 NumNodes);
+
+    // Whether the node has been reached by the current query
+    bool IsVisited(int32 NodeIndex) const { return VisitStamps[NodeIndex] == Generation; }
+
+    // Whether the node has been expanded by the current query
+    bool IsClosed(int32 NodeIndex) const { return ClosedStamps[NodeIndex] == Generation; }
+
+    // Cost from the start node, MAX_int32 if the node has not been reached
+    int32 GetGCost(int32 NodeIndex) const { return IsVisited(NodeIndex) ? GCosts[NodeIndex] : MAX_int32; }
+
+    // Node the best known path arrives from, INDEX_NONE for the start node or unreached nodes
+    int32 GetParent(int32 NodeIndex) const { return IsVisited(NodeIndex) ? Parents[NodeIndex] : INDEX_NONE; }
+
+    // Records the best known path to a node
+    void SetNode(int32 NodeIndex, int32 GCost, int32 ParentIndex)
+    {
+        VisitStamps[NodeIndex] = Generation;
+        GCosts[NodeIndex] = GCost;
+        Parents[NodeIndex] = ParentIndex;
+    }
+
+    // Marks a node as expanded
+    void Close(int32 NodeIndex) { ClosedStamps[NodeIndex] = Generation; }
+
+    // Nodes waiting to be expanded
+    FPathfindingOpenSet& GetOpenSet() { return OpenSet; }
+
+    // Follows the parents back from EndIndex and writes the path from the start node to EndIndex
+    void BuildPath(int32 EndIndex, TArray<int32>& OutPath) const;
+
+    // Flag polled by the searches. Once it is set the running search stops and reports no path
+    void SetCancellationFlag(const std::atomic<bool>* InCancellationFlag) { CancellationFlag = InCancellationFlag; }
+
+    // Whether the current query has been cancelled
+    bool IsCancelled() const { return CancellationFlag && CancellationFlag->load(std::memory_order_relaxed); }
+
+private:
+    // Generation of the current query. Stamps that differ from it belong to earlier queries
+    uint32 Generation = 0;
+
+    TArray<uint32> VisitStamps;
+    TArray<uint32> ClosedStamps;
+    TArray<int32> GCosts;
+    TArray<int32> Parents;
+
+    FPathfindingOpenSet OpenSet;
+
+    const std::atomic<bool>* CancellationFlag = nullptr;
+};
+
+// Thread-safe pool of search contexts for worker threads, so workers reuse scratch arrays instead of allocating per query
+class WALLCLIMBER_ANDRE_API FPathfindingSearchContextPool
+{
+public:
+    // Pool shared by every pathfinding worker
+    static FPathfindingSearchContextPool& Get();
+
+    // Takes a free context from the pool, or creates one if none is free
+    TUniquePtr<FPathfindingSearchContext> Acquire();
+
+    // Returns a context to the pool
+    void Release(TUniquePtr<FPathfindingSearchContext> Context);
+
+private:
+    FCriticalSection Mutex;
+    TArray<TUniquePtr<FPathfindingSearchContext>> FreeContexts;
+};
+
+// Borrows a pooled search context for the lifetime of the scope
+class FScopedPathfindingSearchContext
+{
+public:
+    FScopedPathfindingSearchContext() : Context(FPathfindingSearchContextPool::Get().Acquire()) {}
+    ~FScopedPathfindingSearchContext() { FPathfindingSearchContextPool::Get().Release(MoveTemp(Context)); }
+
+    FPathfindingSearchContext& operator*() const { return *Context; }
+    FPathfindingSearchContext* operator->() const { return Context.Get(); }
+
+private:
+    TUniquePtr<FPathfindingSearchContext> Context;
+};
+
+namespace PathfindingSearch
+{
+    // Finds the shortest path between two nodes using the A* algorithm and writes its node indices into OutPath
+    // Returns false if no path exists
+    WALLCLIMBER_ANDRE_API bool FindAStarPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath);
+
+    // Finds the shortest path with two A* searches, one from each end, and stops once neither side can improve on the best meeting
+    // Same path cost as FindAStarPath. Gives up as soon as either end turns out to be walled off. The backward search borrows a pooled context
+    WALLCLIMBER_ANDRE_API bool FindBidirectionalAStarPath(const FPathfindingGraph& Graph, int32 StartIndex, int32 EndIndex, FPathfindingSearchContext& Context, TArray<int32>& OutPath);
+
+    // Reduces a grid path to its corner waypoints: each waypoint is followed by the farthest later node it has line of sight to
+    // Collinear and zig-zag nodes drop out, and the character walks straight between the waypoints that remain
+    WALLCLIMBER_ANDRE_API void StringPullPath(const FPathfindingGraph& Graph, TArray<int32>& InOutPath);
+}
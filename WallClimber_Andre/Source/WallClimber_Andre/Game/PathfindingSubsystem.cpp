@@ -0,0 +1,265 @@
+/*
+    PathfindingSubsystem.cpp
+    Purpose: Implementation of the PathfindingSubsystem class.
+*/
+
+#include "PathfindingSubsystem.h"
+#include "PathfindingGraph.h"
+#include "NavigationBuilder.h"
+#include "HAL/PlatformTime.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+
+// Steps the time-sliced searches within the per-frame budget
+void UPathfindingSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    const int32 NumSearches = TimeSlicedSearches.Num();
+    if (NumSearches == 0)
+    {
+        return;
+    }
+
+    const double DeadlineSeconds = FPlatformTime::Seconds() + MaxMillisecondsPerFrame / 1000.0;
+    int32 ExpansionBudget = MaxExpansionsPerFrame;
+
+    // Every search gets an even share per turn. Budget left by searches that end early goes around again to the others
+    const int32 ExpansionsPerTurn = FMath::Max(1, MaxExpansionsPerFrame / NumSearches);
+    int32 NumPending = 0;
+    for (const FTimeSlicedSearchEntry& Entry : TimeSlicedSearches)
+    {
+        NumPending += Entry.Search->GetStatus() == EPathSearchStatus::Pending ? 1 : 0;
+    }
+    int32 SearchIndex = NextTimeSlicedSearch % NumSearches;
+
+    while (ExpansionBudget > 0 && NumPending > 0 && FPlatformTime::Seconds() < DeadlineSeconds)
+    {
+        FPathfindingTimeSlicedSearch& Search = *TimeSlicedSearches[SearchIndex].Search;
+        if (Search.GetStatus() == EPathSearchStatus::Pending)
+        {
+            int32 TurnBudget = FMath::Min(ExpansionsPerTurn, ExpansionBudget);
+            ExpansionBudget -= TurnBudget;
+            NumPending -= Search.Step(TurnBudget, DeadlineSeconds) != EPathSearchStatus::Pending ? 1 : 0;
+            ExpansionBudget += TurnBudget;
+        }
+        SearchIndex = (SearchIndex + 1) % NumSearches;
+    }
+    NextTimeSlicedSearch = SearchIndex;
+
+    // Completion delegates may queue new searches, so finished ones are taken out before any of them runs
+    TArray<FTimeSlicedSearchEntry> FinishedSearches;
+    for (int32 Index = TimeSlicedSearches.Num() - 1; Index >= 0; --Index)
+    {
+        if (TimeSlicedSearches[Index].Search->GetStatus() != EPathSearchStatus::Pending)
+        {
+            FinishedSearches.Add(MoveTemp(TimeSlicedSearches[Index]));
+            TimeSlicedSearches.RemoveAt(Index, 1, false);
+            NextTimeSlicedSearch -= Index < NextTimeSlicedSearch ? 1 : 0;
+        }
+    }
+
+    for (int32 Index = FinishedSearches.Num() - 1; Index >= 0; --Index)
+    {
+        FinishedSearches[Index].OnComplete.ExecuteIfBound(*FinishedSearches[Index].Search);
+    }
+}
+
+TStatId UPathfindingSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UPathfindingSubsystem, STATGROUP_Tickables);
+}
+
+// Stops following the edits of the NavigationBuilders
+void UPathfindingSubsystem::Deinitialize()
+{
+    for (FNavigationGraphEntry& Entry : NavigationGraphs)
+    {
+        if (ANavigationBuilder* NavBuilder = Entry.NavBuilder.Get())
+        {
+            NavBuilder->OnNavigationUpdated.Remove(Entry.NavigationUpdatedHandle);
+        }
+    }
+    NavigationGraphs.Empty();
+
+    Super::Deinitialize();
+}
+
+// Graph of the NavigationBuilder, built on the first call and shared by every component searching on it
+FPathfindingGraphPtr UPathfindingSubsystem::AcquireGraph(ANavigationBuilder& NavBuilder, int32 MaxLandmarks, int64 LandmarkBudgetBytes)
+{
+    if (const FNavigationGraphEntry* Entry = FindGraphEntry(&NavBuilder))
+    {
+        return Entry->Graph;
+    }
+
+    // Forget builders destroyed since
+    NavigationGraphs.RemoveAll([](const FNavigationGraphEntry& Entry) { return !Entry.NavBuilder.IsValid(); });
+
+    FNavigationGraphEntry& Entry = NavigationGraphs.AddDefaulted_GetRef();
+    Entry.NavBuilder = &NavBuilder;
+    Entry.MaxLandmarks = MaxLandmarks;
+    Entry.LandmarkBudgetBytes = LandmarkBudgetBytes;
+    Entry.Graph = FPathfindingGraph::Build(NavBuilder, MaxLandmarks, LandmarkBudgetBytes);
+    Entry.SearchGraph = Entry.Graph;
+    Entry.NavigationUpdatedHandle = NavBuilder.OnNavigationUpdated.AddUObject(this, &UPathfindingSubsystem::HandleNavigationUpdated, static_cast<const ANavigationBuilder*>(&NavBuilder));
+
+    return Entry.Graph;
+}
+
+// Latest graph of the NavigationBuilder, its search tables possibly behind
+FPathfindingGraphPtr UPathfindingSubsystem::GetGraph(const ANavigationBuilder* NavBuilder) const
+{
+    const FNavigationGraphEntry* Entry = FindGraphEntry(NavBuilder);
+    return Entry ? Entry->Graph : FPathfindingGraphPtr();
+}
+
+// Latest graph of the NavigationBuilder whose search tables are complete
+FPathfindingGraphPtr UPathfindingSubsystem::GetSearchGraph(const ANavigationBuilder* NavBuilder) const
+{
+    const FNavigationGraphEntry* Entry = FindGraphEntry(NavBuilder);
+    return Entry ? Entry->SearchGraph : FPathfindingGraphPtr();
+}
+
+// Replaces the graph of the NavigationBuilder after it edited or rebuilt its nodes
+void UPathfindingSubsystem::HandleNavigationUpdated(const TArray<FIntPoint>& ChangedIDs, const ANavigationBuilder* NavBuilder)
+{
+    FNavigationGraphEntry* Entry = FindGraphEntry(NavBuilder);
+    ANavigationBuilder* Builder = Entry ? Entry->NavBuilder.Get() : nullptr;
+    if (!Builder)
+    {
+        return;
+    }
+
+    // The graph is shared with running searches, so edits go into a new graph that replaces it
+    // Only the topology is refreshed here. A worker then repairs the search tables, for every edit since the last repair at once
+    if (ChangedIDs.Num() > 0)
+    {
+        Entry->Graph = FPathfindingGraph::Update(*Entry->Graph, *Builder, ChangedIDs, true);
+        StartSearchTableRepair(*Entry);
+    }
+    else
+    {
+        Entry->Graph = FPathfindingGraph::Build(*Builder, Entry->MaxLandmarks, Entry->LandmarkBudgetBytes);
+        Entry->SearchGraph = Entry->Graph;
+    }
+
+    OnGraphUpdated.Broadcast(NavBuilder, ChangedIDs);
+}
+
+// Repairs the search tables of the entry's latest graph on a worker
+void UPathfindingSubsystem::StartSearchTableRepair(FNavigationGraphEntry& Entry)
+{
+    if (Entry.bRepairingSearchTables || !Entry.Graph->HasPendingSearchTables())
+    {
+        return;
+    }
+    Entry.bRepairingSearchTables = true;
+
+    // The worker only reads the immutable graph. The repaired copy goes back to the game thread, where the entries live
+    const FPathfindingGraphPtr Pending = Entry.Graph;
+    const ANavigationBuilder* NavBuilder = Entry.NavBuilder.Get();
+    const TWeakObjectPtr<UPathfindingSubsystem> WeakThis(this);
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [Pending, NavBuilder, WeakThis]()
+    {
+        FPathfindingGraphPtr Repaired = FPathfindingGraph::CompleteSearchTables(*Pending);
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, NavBuilder, Repaired = MoveTemp(Repaired)]()
+        {
+            if (UPathfindingSubsystem* This = WeakThis.Get())
+            {
+                This->FinishSearchTableRepair(NavBuilder, Repaired);
+            }
+        });
+    });
+}
+
+// Swaps the repaired graph in on the game thread
+void UPathfindingSubsystem::FinishSearchTableRepair(const ANavigationBuilder* NavBuilder, const FPathfindingGraphPtr& Repaired)
+{
+    FNavigationGraphEntry* Entry = FindGraphEntry(NavBuilder);
+    if (!Entry)
+    {
+        return;
+    }
+    Entry->bRepairingSearchTables = false;
+
+    // A full rebuild since the repair started already left a newer complete graph
+    if (Repaired->NavigationVersion > Entry->SearchGraph->NavigationVersion)
+    {
+        Entry->SearchGraph = Repaired;
+    }
+
+    // Without edits meanwhile the repaired graph is also the latest one. Otherwise their tables are still behind and get the next repair
+    if (Entry->Graph->NavigationVersion == Repaired->NavigationVersion)
+    {
+        Entry->Graph = Repaired;
+    }
+    else
+    {
+        StartSearchTableRepair(*Entry);
+    }
+}
+
+// Entry of the NavigationBuilder, null if its graph was never acquired
+UPathfindingSubsystem::FNavigationGraphEntry* UPathfindingSubsystem::FindGraphEntry(const ANavigationBuilder* NavBuilder)
+{
+    return NavigationGraphs.FindByPredicate([NavBuilder](const FNavigationGraphEntry& Entry) { return NavBuilder && Entry.NavBuilder.Get() == NavBuilder; });
+}
+
+// Entry of the NavigationBuilder, null if its graph was never acquired
+const UPathfindingSubsystem::FNavigationGraphEntry* UPathfindingSubsystem::FindGraphEntry(const ANavigationBuilder* NavBuilder) const
+{
+    return NavigationGraphs.FindByPredicate([NavBuilder](const FNavigationGraphEntry& Entry) { return NavBuilder && Entry.NavBuilder.Get() == NavBuilder; });
+}
+
+// Queues a search to be stepped every frame until it ends
+void UPathfindingSubsystem::AddTimeSlicedSearch(const TSharedRef<FPathfindingTimeSlicedSearch>& Search, FOnTimeSlicedSearchComplete OnComplete)
+{
+    TimeSlicedSearches.Add(FTimeSlicedSearchEntry{ Search, MoveTemp(OnComplete) });
+}
+
+// Node expansions and milliseconds all time-sliced searches may use together each frame
+void UPathfindingSubsystem::SetTimeSlicedBudget(int32 InMaxExpansionsPerFrame, float InMaxMillisecondsPerFrame)
+{
+    MaxExpansionsPerFrame = FMath::Max(InMaxExpansionsPerFrame, 1);
+    MaxMillisecondsPerFrame = FMath::Max(InMaxMillisecondsPerFrame, 0.0f);
+}
+
+// Flow field toward a goal node of the graph, shared by every agent heading there
+TSharedRef<const FPathfindingFlowField, ESPMode::ThreadSafe> UPathfindingSubsystem::AcquireFlowField(const FPathfindingGraph& Graph, int32 GoalIndex)
+{
+    // Forget fields nobody holds anymore and fields from an older navigation version
+    for (auto It = FlowFields.CreateIterator(); It; ++It)
+    {
+        const TSharedPtr<const FPathfindingFlowField, ESPMode::ThreadSafe> FlowField = It.Value().Pin();
+        if (!FlowField || FlowField->GetNavigationVersion() != Graph.NavigationVersion)
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    if (const TWeakPtr<const FPathfindingFlowField, ESPMode::ThreadSafe>* CachedFlowField = FlowFields.Find(GoalIndex))
+    {
+        if (const TSharedPtr<const FPathfindingFlowField, ESPMode::ThreadSafe> FlowField = CachedFlowField->Pin())
+        {
+            return FlowField.ToSharedRef();
+        }
+    }
+
+    TSharedRef<FPathfindingFlowField, ESPMode::ThreadSafe> FlowField = MakeShared<FPathfindingFlowField, ESPMode::ThreadSafe>();
+    FlowField->Build(Graph, GoalIndex);
+    FlowFields.Add(GoalIndex, FlowField);
+
+    return FlowField;
+}
+
+// Number of flow fields some agent still holds
+int32 UPathfindingSubsystem::GetNumFlowFields() const
+{
+    int32 NumFlowFields = 0;
+    for (const TPair<int32, TWeakPtr<const FPathfindingFlowField, ESPMode::ThreadSafe>>& FlowField : FlowFields)
+    {
+        NumFlowFields += FlowField.Value.IsValid() ? 1 : 0;
+    }
+    return NumFlowFields;
+}
@@ -0,0 +1,126 @@
+/*
+    PathfindingSubsystem.h
+    Purpose: Header file for the PathfindingSubsystem class, the per-world owner of pathfinding data shared by every PathfindingComponent.
+    It builds the graph of each NavigationBuilder once and keeps it up to date with the builder's edits for every component searching on it,
+    keeps the flow fields toward goals that several agents are heading to, so each field is computed once for all of them,
+    and steps the time-sliced searches of every component within one per-frame budget.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PathfindingFlowField.h"
+#include "PathfindingTimeSlicedSearch.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSubsystem.generated.h"
+
+class ANavigationBuilder;
+
+// Called on the game thread when a time-sliced search succeeds or fails. The handler may move the path out of the search
+DECLARE_DELEGATE_OneParam(FOnTimeSlicedSearchComplete, FPathfindingTimeSlicedSearch& /*Search*/);
+
+// Called on the game thread after the graph of a NavigationBuilder was replaced. ChangedIDs is empty after a full rebuild
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPathfindingGraphUpdated, const ANavigationBuilder* /*NavBuilder*/, const TArray<FIntPoint>& /*ChangedIDs*/);
+
+// World subsystem for pathfinding data shared between agents
+UCLASS()
+class WALLCLIMBER_ANDRE_API UPathfindingSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // Steps the time-sliced searches within the per-frame budget
+    virtual void Tick(float DeltaTime) override;
+
+    virtual TStatId GetStatId() const override;
+
+    // Stops following the edits of the NavigationBuilders
+    virtual void Deinitialize() override;
+
+    // Graph of the NavigationBuilder, shared by every component searching on it. The first call builds it with its landmark settings,
+    // later calls get the same graph whatever they ask for. From then on every edit of the builder replaces it once for all of them
+    FPathfindingGraphPtr AcquireGraph(ANavigationBuilder& NavBuilder, int32 MaxLandmarks, int64 LandmarkBudgetBytes);
+
+    // Latest graph of the NavigationBuilder. Its search tables may still lag behind an edit. Null if it was never acquired
+    FPathfindingGraphPtr GetGraph(const ANavigationBuilder* NavBuilder) const;
+
+    // Latest graph of the NavigationBuilder whose search tables are complete. Null if it was never acquired
+    // Never waits: right after an edit this is the graph before it, until the worker repairing the tables swaps the new one in
+    FPathfindingGraphPtr GetSearchGraph(const ANavigationBuilder* NavBuilder) const;
+
+    // Broadcast once the graph of a NavigationBuilder was replaced after an edit or rebuild
+    FOnPathfindingGraphUpdated OnGraphUpdated;
+
+    // Flow field toward a goal node of the graph. Agents heading to the same goal share one field, which lives as long as one of them holds it
+    // Fields are tied to the navigation version they were built on. Once the graph changes the field is rebuilt for the next agent asking,
+    // and agents still holding the old one should acquire it again
+    TSharedRef<const FPathfindingFlowField, ESPMode::ThreadSafe> AcquireFlowField(const FPathfindingGraph& Graph, int32 GoalIndex);
+
+    // Number of flow fields some agent still holds
+    int32 GetNumFlowFields() const;
+
+    // Queues a search to be stepped every frame until it ends. OnComplete runs once it succeeds or fails
+    void AddTimeSlicedSearch(const TSharedRef<FPathfindingTimeSlicedSearch>& Search, FOnTimeSlicedSearchComplete OnComplete);
+
+    // Node expansions and milliseconds all time-sliced searches may use together each frame, whichever runs out first
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    void SetTimeSlicedBudget(int32 InMaxExpansionsPerFrame, float InMaxMillisecondsPerFrame);
+
+    // Number of time-sliced searches still running
+    int32 GetNumTimeSlicedSearches() const { return TimeSlicedSearches.Num(); }
+
+private:
+    // Graph of one NavigationBuilder and the landmark settings it is rebuilt with
+    struct FNavigationGraphEntry
+    {
+        TWeakObjectPtr<ANavigationBuilder> NavBuilder;
+        FDelegateHandle NavigationUpdatedHandle;
+
+        // Node topology after the latest edit. Edits leave its search tables behind until a worker repairs them
+        FPathfindingGraphPtr Graph;
+
+        // Latest graph whose search tables are complete, what searches run on
+        FPathfindingGraphPtr SearchGraph;
+
+        // Whether a worker is repairing the search tables. Edits meanwhile wait for it and start the next repair
+        bool bRepairingSearchTables = false;
+
+        int32 MaxLandmarks = 0;
+        int64 LandmarkBudgetBytes = 0;
+    };
+
+    // Replaces the graph of the NavigationBuilder after it edited or rebuilt its nodes, then tells the components
+    void HandleNavigationUpdated(const TArray<FIntPoint>& ChangedIDs, const ANavigationBuilder* NavBuilder);
+
+    // Repairs the search tables of the entry's latest graph on a worker, unless a repair is already running
+    void StartSearchTableRepair(FNavigationGraphEntry& Entry);
+
+    // Swaps the repaired graph in on the game thread and starts the next repair if the builder was edited meanwhile
+    void FinishSearchTableRepair(const ANavigationBuilder* NavBuilder, const FPathfindingGraphPtr& Repaired);
+
+    // Entry of the NavigationBuilder, null if its graph was never acquired
+    FNavigationGraphEntry* FindGraphEntry(const ANavigationBuilder* NavBuilder);
+    const FNavigationGraphEntry* FindGraphEntry(const ANavigationBuilder* NavBuilder) const;
+
+    // One graph per NavigationBuilder. Levels rarely have more than one, so they are searched linearly
+    TArray<FNavigationGraphEntry> NavigationGraphs;
+
+    struct FTimeSlicedSearchEntry
+    {
+        TSharedRef<FPathfindingTimeSlicedSearch> Search;
+        FOnTimeSlicedSearchComplete OnComplete;
+    };
+
+    // Running time-sliced searches, stepped round-robin
+    TArray<FTimeSlicedSearchEntry> TimeSlicedSearches;
+
+    // Search the next frame starts with, so searches at the back of the list are not starved when the budget runs out
+    int32 NextTimeSlicedSearch = 0;
+
+    int32 MaxExpansionsPerFrame = 4096;
+    float MaxMillisecondsPerFrame = 1.0f;
+
+    // Flow fields by goal node. Weak, the agents holding a field are what keeps it alive
+    TMap<int32, TWeakPtr<const FPathfindingFlowField, ESPMode::ThreadSafe>> FlowFields;
+};
@@ -0,0 +1,110 @@
+/*
+    PathfindingTimeSlicedSearch.cpp
+    Purpose: Implementation of the time-sliced A* search.
+*/
+
+#include "PathfindingTimeSlicedSearch.h"
+#include "HAL/PlatformTime.h"
+
+// Prepares a search between two nodes of the graph
+FPathfindingTimeSlicedSearch::FPathfindingTimeSlicedSearch(const FPathfindingGraphPtr& InGraph, int32 InStartIndex, int32 InEndIndex, const std::atomic<bool>* CancellationFlag)
+    : Graph(InGraph)
+    , StartIndex(InStartIndex)
+    , EndIndex(InEndIndex)
+{
+    // Endpoints in different connected components fail at once instead of spending frames on the search
+    if (!Graph || !Graph->AreConnected(StartIndex, EndIndex))
+    {
+        Status = EPathSearchStatus::Failed;
+        return;
+    }
+
+    Context = FPathfindingSearchContextPool::Get().Acquire();
+    Context->SetCancellationFlag(CancellationFlag);
+    Context->BeginQuery(Graph->Num());
+
+    // Add the start node to the open set
+    const int32 StartHCost = Graph->GetLandmarkHeuristic(StartIndex, EndIndex);
+    Context->SetNode(StartIndex, 0, INDEX_NONE);
+    Context->GetOpenSet().Push(StartIndex, StartHCost, StartHCost);
+}
+
+FPathfindingTimeSlicedSearch::~FPathfindingTimeSlicedSearch()
+{
+    if (Context)
+    {
+        Finish(EPathSearchStatus::Failed);
+    }
+}
+
+// Expands nodes until the search ends or the budget runs out
+EPathSearchStatus FPathfindingTimeSlicedSearch::Step(int32& InOutExpansionBudget, double DeadlineSeconds)
+{
+    if (Status != EPathSearchStatus::Pending)
+    {
+        return Status;
+    }
+
+    // Reading the clock costs about as much as a few expansions, so it is only checked every few of them
+    constexpr int32 ExpansionsPerTimeCheck = 32;
+
+    const FPathfindingGraph& SearchGraph = *Graph;
+    FPathfindingOpenSet& OpenSet = Context->GetOpenSet();
+
+    for (int32 Expansions = 0; InOutExpansionBudget > 0; ++Expansions)
+    {
+        if (Context->IsCancelled() || OpenSet.IsEmpty())
+        {
+            Finish(EPathSearchStatus::Failed);
+            break;
+        }
+
+        if (Expansions > 0 && Expansions % ExpansionsPerTimeCheck == 0 && FPlatformTime::Seconds() >= DeadlineSeconds)
+        {
+            break;
+        }
+
+        // Same expansion as PathfindingSearch::FindAStarPath, one node at a time
+        const int32 CurrentIndex = OpenSet.Pop();
+        Context->Close(CurrentIndex);
+        --InOutExpansionBudget;
+        ++NumExpandedNodes;
+
+        if (CurrentIndex == EndIndex)
+        {
+            Path.Initialize(Graph);
+            Context->BuildPath(EndIndex, Path.GetNodeIndices());
+            Finish(EPathSearchStatus::Succeeded);
+            break;
+        }
+
+        const FIntPoint CurrentID = SearchGraph.NodeIDs[CurrentIndex];
+        const int32 CurrentGCost = Context->GetGCost(CurrentIndex);
+
+        for (uint32 Moves = SearchGraph.NeighborMasks[CurrentIndex]; Moves != 0; Moves &= Moves - 1)
+        {
+            const int32 Direction = FMath::CountTrailingZeros(Moves);
+            const FIntPoint& NeighborOffset = FPathfindingJumpTable::Directions[Direction];
+            const int32 NeighborIndex = SearchGraph.GetNeighbor(CurrentID, Direction);
+            const int32 TentativeGScore = CurrentGCost + FPathfindingGraph::GetMovementCost(NeighborOffset);
+            if (TentativeGScore >= Context->GetGCost(NeighborIndex))
+            {
+                continue;
+            }
+
+            const int32 HCost = SearchGraph.GetLandmarkHeuristic(NeighborIndex, EndIndex);
+            Context->SetNode(NeighborIndex, TentativeGScore, CurrentIndex);
+            OpenSet.Push(NeighborIndex, TentativeGScore + HCost, HCost);
+        }
+    }
+
+    return Status;
+}
+
+// Ends the search and hands the context back to the pool
+void FPathfindingTimeSlicedSearch::Finish(EPathSearchStatus FinalStatus)
+{
+    Status = FinalStatus;
+    Context->SetCancellationFlag(nullptr);
+    FPathfindingSearchContextPool::Get().Release(MoveTemp(Context));
+}
@@ -0,0 +1,65 @@
+/*
+    PathfindingTimeSlicedSearch.h
+    Purpose: Header file for the time-sliced A* search, a search that can be paused and resumed across frames.
+    Each Step expands nodes until a budget of expansions or a deadline runs out, so a long search is spread over several frames
+    instead of stalling one. The UPathfindingSubsystem steps every running search within one global per-frame budget.
+*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingGraph.h"
+#include "PathfindingSearch.h"
+#include "PathfindingPath.h"
+#include "PathfindingTimeSlicedSearch.generated.h"
+
+// Progress of a time-sliced search
+UENUM(BlueprintType)
+enum class EPathSearchStatus : uint8
+{
+    // Still expanding nodes, call Step again
+    Pending,
+    // A path was found
+    Succeeded,
+    // No path exists, or the search was cancelled
+    Failed
+};
+
+// A* search that runs a bounded number of node expansions per Step
+class WALLCLIMBER_ANDRE_API FPathfindingTimeSlicedSearch
+{
+public:
+    // Prepares a search between two nodes of the graph. The search keeps the graph alive and borrows a pooled context until it ends
+    FPathfindingTimeSlicedSearch(const FPathfindingGraphPtr& InGraph, int32 InStartIndex, int32 InEndIndex, const std::atomic<bool>* CancellationFlag = nullptr);
+    ~FPathfindingTimeSlicedSearch();
+
+    // Expands nodes until the search ends, InOutExpansionBudget reaches zero or the platform time passes DeadlineSeconds
+    // The expansions used are subtracted from InOutExpansionBudget
+    EPathSearchStatus Step(int32& InOutExpansionBudget, double DeadlineSeconds);
+
+    EPathSearchStatus GetStatus() const { return Status; }
+
+    // Path from start to end, empty unless the search succeeded. May be moved out once the search has ended
+    FPathfindingPath& GetPath() { return Path; }
+    const FPathfindingPath& GetPath() const { return Path; }
+
+    const FPathfindingGraphPtr& GetGraph() const { return Graph; }
+
+    // Nodes expanded over every Step so far
+    int32 GetNumExpandedNodes() const { return NumExpandedNodes; }
+
+private:
+    // Ends the search and hands the context back to the pool
+    void Finish(EPathSearchStatus FinalStatus);
+
+    FPathfindingGraphPtr Graph;
+    int32 StartIndex;
+    int32 EndIndex;
+
+    // Scratch state of the search, held between steps and released as soon as it ends
+    TUniquePtr<FPathfindingSearchContext> Context;
+
+    EPathSearchStatus Status = EPathSearchStatus::Pending;
+    FPathfindingPath Path;
+    int32 NumExpandedNodes = 0;
+};
@@ -164,30 +164,38 @@ void APointAndClickController::ProcessPathfinding(const FVector& TargetLocation)
     FVector PlayerLocation = ControlledCharacter->GetActorLocation() - FVector(-45.f, 0.f, 0.f);
 
     // Find closest node to that location
-    FPathfindingNode* ClosestNode = PathfindingComp->GetClosestNode(PlayerLocation);
-    if (!ClosestNode)
+    const int32 ClosestNode = PathfindingComp->GetClosestNodeIndex(PlayerLocation);
+    if (ClosestNode == INDEX_NONE)
     {
         UE_LOG(LogTemp, Warning, TEXT("NO CLOSEST NODE FOUND"));
         return;
     }
+    const FVector ClosestLocation = PathfindingComp->GetNode(ClosestNode).Location;
 
     // Highlight the closest node
-    DrawDebugPoint(GetWorld(), ClosestNode->Location, 10.f, FColor::Emerald, true, -1.f);
-    UE_LOG(LogTemp, Warning, TEXT("Closest Node Found at %s"), *ClosestNode->Location.ToString());
+    DrawDebugPoint(GetWorld(), ClosestLocation, 10.f, FColor::Emerald, true, -1.f);
+    UE_LOG(LogTemp, Warning, TEXT("Closest Node Found at %s"), *ClosestLocation.ToString());
 
     // Find Closest Node to target location
-    FPathfindingNode* TargetNode = PathfindingComp->GetClosestNode(TargetLocation);
-    if (!TargetNode)
+    const int32 TargetNode = PathfindingComp->GetClosestNodeIndex(TargetLocation);
+    if (TargetNode == INDEX_NONE)
     {
         UE_LOG(LogTemp, Warning, TEXT("NO TARGET NODE FOUND"));
         return;
     }
+    const FVector TargetNodeLocation = PathfindingComp->GetNode(TargetNode).Location;
 
-    DrawDebugPoint(GetWorld(), TargetNode->Location, 10.f, FColor::Magenta, true, -1.f);
-    UE_LOG(LogTemp, Warning, TEXT("Target Node Found at %s"), *TargetNode->Location.ToString());
+    DrawDebugPoint(GetWorld(), TargetNodeLocation, 10.f, FColor::Magenta, true, -1.f);
+    UE_LOG(LogTemp, Warning, TEXT("Target Node Found at %s"), *TargetNodeLocation.ToString());
 
-    // Make Path
-    TArray<FPathfindingNode> CurrentPath = PathfindingComp->CalculateAStarPath(ClosestNode, TargetNode);
+    // Make Path on a worker thread. A new click supersedes the path still being searched for the previous one
+    PathfindingComp->RequestPathAsync(ClosestLocation, TargetNodeLocation,
+        FOnPathRequestComplete::CreateUObject(this, &APointAndClickController::OnPathfindingComplete),
+        EPathRequestPriority::Player, PathfindingSearchMode, this);
+}
+
+void APointAndClickController::OnPathfindingComplete(FPathRequestHandle Handle, FPathfindingPath& CurrentPath)
+{
     if (CurrentPath.Num() <= 0)
     {
         UE_LOG(LogTemp, Warning, TEXT("NO PATH FOUND"));
@@ -197,12 +205,12 @@ void APointAndClickController::ProcessPathfinding(const FVector& TargetLocation)
     // Draw debug points for the path
     for (int32 i = 1; i < CurrentPath.Num(); i++)
     {
-        DrawDebugPoint(GetWorld(), CurrentPath[i].Location, 10.f, FColor::Cyan, true, -1.f);
+        DrawDebugPoint(GetWorld(), CurrentPath.GetLocation(i), 10.f, FColor::Cyan, true, -1.f);
     }
     UE_LOG(LogTemp, Warning, TEXT("Path created. Total nodes: %d"), CurrentPath.Num());
 
     // Move the character along the path
-    //ControlledCharacter->Move(CurrentPath);
+    //ControlledCharacter->Move(MoveTemp(CurrentPath));
 }
 
 
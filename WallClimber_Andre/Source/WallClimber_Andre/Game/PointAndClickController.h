@@ -10,6 +10,7 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "NiagaraSystem.h"
+#include "PathfindingComponent.h"
 
 #include "PointAndClickController.generated.h"
 
@@ -42,6 +43,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UNiagaraSystem* PointClickFX;
 
+	// Search algorithm used for click-to-move paths
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+	EPathfindingSearchMode PathfindingSearchMode = EPathfindingSearchMode::AStar;
+
 
 
 protected:
@@ -51,6 +56,9 @@ protected:
 
 	void ProcessPathfinding(const FVector& TargetLocation);
 
+	// Called on the game thread when the path requested by ProcessPathfinding is ready
+	void OnPathfindingComplete(FPathRequestHandle Handle, FPathfindingPath& CurrentPath);
+
 	void HandleCameraRotation(const FInputActionValue& Value);
 	void HandleCameraZoom(const FInputActionValue& Value);
 	void ResetRotation(const FInputActionValue& Value);
@@ -0,0 +1,299 @@
+/*
+    PathfindingGraphUpdateTest.cpp
+    Purpose: Automation test checking that a pathfinding graph updated after node edits matches a graph built from scratch on the same nodes.
+    Covers the topology, the jump table, the clusters, the landmarks and D* Lite, with the search tables repaired right away or deferred.
+*/
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "UObject/Package.h"
+#include "Game/NavigationBuilder.h"
+#include "Game/NavigationGridData.h"
+#include "Game/PathfindingGraph.h"
+#include "Game/PathfindingKernels.h"
+#include "Game/PathfindingSearch.h"
+#include "Game/PathfindingJumpPoints.h"
+#include "Game/PathfindingHierarchy.h"
+#include "Game/PathfindingLandmarks.h"
+#include "Game/PathfindingDStarLite.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    // Spawns a NavigationBuilder in World that loads a random grid with about HoleFraction of its cells without a node
+    // and BlockedFraction of the nodes invalid, instead of tracing the world
+    ANavigationBuilder* SpawnRandomNavigationBuilder(UWorld& World, FRandomStream& Random, float HoleFraction, float BlockedFraction)
+    {
+        ANavigationBuilder* Builder = World.SpawnActor<ANavigationBuilder>();
+        Builder->NavMeshExtents = FVector(Random.RandRange(5, 40) * 100.f, Random.RandRange(5, 40) * 100.f, 200.f);
+
+        // The layout must match the builder's settings and placement, or it ignores the payload and traces
+        FNavigationGridLayout Layout;
+        Layout.Transform = Builder->GetActorTransform();
+        Layout.Spacing = Builder->SpacingUnits / Builder->NavMeshDensity;
+        Layout.Extents = Builder->NavMeshExtents;
+
+        FNavigationGridIndex GridIndex;
+        GridIndex.Initialize(FMath::FloorToInt(Layout.Extents.X * 2 / Layout.Spacing), FMath::FloorToInt(Layout.Extents.Y * 2 / Layout.Spacing));
+        TArray<FNavigationNode> Nodes;
+        TArray<bool> WalkableCells;
+        WalkableCells.Init(true, GridIndex.NodeIndices.Num());
+
+        // Nodes in grid order, as a full build leaves them
+        for (int32 X = 0; X < GridIndex.SizeX; ++X)
+        {
+            for (int32 Y = 0; Y < GridIndex.SizeY; ++Y)
+            {
+                if (Random.FRand() < HoleFraction)
+                {
+                    continue;
+                }
+
+                FNavigationNode& Node = Nodes.AddDefaulted_GetRef();
+                Node.ID = FIntPoint(X, Y);
+                Node.Location = Layout.GridIDToLocal(Node.ID);
+                Node.bIsValid = Random.FRand() >= BlockedFraction;
+                GridIndex.Add(Node.ID, Nodes.Num() - 1);
+            }
+        }
+
+        // Without labels in the payload the builder labels the components itself
+        UNavigationGridData* GridData = NewObject<UNavigationGridData>(GetTransientPackage());
+        GridData->Store(Layout, GridIndex, Builder->ThresholdBuffer, Nodes, WalkableCells, FNavigationComponentLabels());
+        Builder->BakedNavigation = GridData;
+        Builder->DispatchBeginPlay();
+        return Builder;
+    }
+
+    // Octile distance from a grid cell to a node, INDEX_NONE if there is no node
+    int32 GetCellDistance(const FPathfindingGraph& Graph, int32 NodeIndex, const FIntPoint& ID)
+    {
+        if (NodeIndex == INDEX_NONE)
+        {
+            return INDEX_NONE;
+        }
+
+        const FIntPoint Delta = Graph.NodeIDs[NodeIndex] - ID;
+        return 10 * FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y)) + 4 * FMath::Min(FMath::Abs(Delta.X), FMath::Abs(Delta.Y));
+    }
+
+    // Octile cost of the path, INDEX_NONE if there is no path
+    int32 GetPathCost(const FPathfindingGraph& Graph, bool bFound, const TArray<int32>& NodeIndices)
+    {
+        if (!bFound)
+        {
+            return INDEX_NONE;
+        }
+
+        int32 Cost = 0;
+        for (int32 PathIndex = 1; PathIndex < NodeIndices.Num(); ++PathIndex)
+        {
+            Cost += Graph.GetHeuristic(NodeIndices[PathIndex - 1], NodeIndices[PathIndex]);
+        }
+        return Cost;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPathfindingGraphUpdateTest, "WallClimber.Pathfinding.GraphUpdateMatchesBuild",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+// Edits random windows of random grids through the NavigationBuilder and compares every updated graph with one built from scratch
+bool FPathfindingGraphUpdateTest::RunTest(const FString& Parameters)
+{
+    constexpr int32 NumGrids = 12;
+    constexpr int32 NumEditsPerGrid = 12;
+    constexpr int32 NumQueriesPerEdit = 32;
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+
+    FRandomStream Random(0);
+    FScopedPathfindingSearchContext Context;
+    TArray<int32> Path;
+
+    // The exact cost the landmark bounds must not exceed. The landmark heuristic itself is one of the tables under test
+    FPathfindingSearchPolicies ExactPolicies;
+    ExactPolicies.Heuristic = EPathfindingHeuristic::Octile;
+
+    for (int32 GridNumber = 0; GridNumber < NumGrids; ++GridNumber)
+    {
+        ANavigationBuilder* Builder = SpawnRandomNavigationBuilder(*World, Random, Random.FRandRange(0.f, 0.15f), Random.FRandRange(0.f, 0.35f));
+        const int32 MaxLandmarks = 1 + GridNumber % 6;
+        const FNavigationGridIndex& GridIndex = Builder->GetGridIndex();
+
+        // Edits are collected the way the subsystem receives them
+        TArray<FIntPoint> ChangedIDs;
+        Builder->OnNavigationUpdated.AddLambda([&ChangedIDs](const TArray<FIntPoint>& IDs) { ChangedIDs.Append(IDs); });
+
+        FPathfindingGraphPtr Graph = FPathfindingGraph::Build(*Builder, MaxLandmarks);
+
+        // The D* Lite agent heads for a goal the edits leave alone, from a start they leave alone
+        TArray<int32> ValidNodes;
+        for (int32 NodeIndex = 0; NodeIndex < Graph->Num(); ++NodeIndex)
+        {
+            if (Graph->IsNodeValid(NodeIndex))
+            {
+                ValidNodes.Add(NodeIndex);
+            }
+        }
+        if (!TestTrue(TEXT("Random grid has valid nodes"), ValidNodes.Num() > 0))
+        {
+            continue;
+        }
+        const int32 AgentStart = ValidNodes[Random.RandHelper(ValidNodes.Num())];
+        const int32 AgentGoal = ValidNodes[Random.RandHelper(ValidNodes.Num())];
+        FPathfindingDStarLite IncrementalSearch;
+        IncrementalSearch.Initialize(Graph, AgentStart, AgentGoal);
+
+        // Odd grids defer the search tables and sometimes let several edits pile up before completing them
+        const bool bDeferSearchTables = GridNumber % 2 == 1;
+
+        for (int32 EditNumber = 0; EditNumber < NumEditsPerGrid; ++EditNumber)
+        {
+            // Block and free nodes in a window, like an obstacle moving across it
+            TArray<FIntPoint> BlockedIDs;
+            TArray<FIntPoint> FreedIDs;
+            const int32 WindowSize = Random.RandRange(1, 8);
+            const FIntPoint WindowMin(Random.RandHelper(GridIndex.SizeX), Random.RandHelper(GridIndex.SizeY));
+            for (int32 X = WindowMin.X; X < FMath::Min(WindowMin.X + WindowSize, GridIndex.SizeX); ++X)
+            {
+                for (int32 Y = WindowMin.Y; Y < FMath::Min(WindowMin.Y + WindowSize, GridIndex.SizeY); ++Y)
+                {
+                    const int32 NodeIndex = GridIndex.Find(FIntPoint(X, Y));
+                    if (NodeIndex != INDEX_NONE && NodeIndex != AgentStart && NodeIndex != AgentGoal)
+                    {
+                        (Random.FRand() < 0.5f ? BlockedIDs : FreedIDs).Add(FIntPoint(X, Y));
+                    }
+                }
+            }
+
+            ChangedIDs.Reset();
+            Builder->SetNodesValidity(BlockedIDs, false);
+            Builder->SetNodesValidity(FreedIDs, true);
+            if (ChangedIDs.Num() == 0)
+            {
+                continue;
+            }
+
+            FPathfindingGraphPtr Updated = FPathfindingGraph::Update(*Graph, *Builder, ChangedIDs, bDeferSearchTables);
+            TestTrue(TEXT("Only a deferred Update leaves the search tables pending"), Updated->HasPendingSearchTables() == bDeferSearchTables);
+            IncrementalSearch.UpdateGraph(Updated, ChangedIDs);
+            Graph = Updated;
+            if (bDeferSearchTables && Random.RandHelper(3) != 0)
+            {
+                continue;
+            }
+            if (bDeferSearchTables)
+            {
+                Graph = Updated = FPathfindingGraph::CompleteSearchTables(*Updated);
+            }
+            TestFalse(TEXT("Completed graph has no pending search tables"), Updated->HasPendingSearchTables());
+
+            const FPathfindingGraphPtr Built = FPathfindingGraph::Build(*Builder, MaxLandmarks);
+            if (!TestEqual(TEXT("Updated graph node count"), Updated->Num(), Built->Num()))
+            {
+                continue;
+            }
+
+            // Topology and jump distances, node by node
+            for (int32 NodeIndex = 0; NodeIndex < Built->Num(); ++NodeIndex)
+            {
+                if (Updated->IsNodeValid(NodeIndex) != Built->IsNodeValid(NodeIndex) || Updated->NeighborMasks[NodeIndex] != Built->NeighborMasks[NodeIndex])
+                {
+                    AddError(FString::Printf(TEXT("Grid %d edit %d: validity or moves of node %d differ from a full build"), GridNumber, EditNumber, NodeIndex));
+                    continue;
+                }
+                if (!Built->IsNodeValid(NodeIndex))
+                {
+                    continue;
+                }
+                for (int32 DirectionIndex = 0; DirectionIndex < 8; ++DirectionIndex)
+                {
+                    if (Updated->JumpTable.GetJumpDistance(NodeIndex, DirectionIndex) != Built->JumpTable.GetJumpDistance(NodeIndex, DirectionIndex))
+                    {
+                        AddError(FString::Printf(TEXT("Grid %d edit %d: jump distance of node %d in direction %d is %d, a full build gives %d"), GridNumber, EditNumber,
+                            NodeIndex, DirectionIndex, Updated->JumpTable.GetJumpDistance(NodeIndex, DirectionIndex), Built->JumpTable.GetJumpDistance(NodeIndex, DirectionIndex)));
+                    }
+                }
+            }
+
+            // Ties between equally near nodes may break either way, so only the distances must agree
+            for (int32 X = 0; X < GridIndex.SizeX; ++X)
+            {
+                for (int32 Y = 0; Y < GridIndex.SizeY; ++Y)
+                {
+                    const FIntPoint ID(X, Y);
+                    const int32 UpdatedNearest = Updated->NearestValidNodes[X * GridIndex.SizeY + Y];
+                    const int32 BuiltNearest = Built->NearestValidNodes[X * GridIndex.SizeY + Y];
+                    if (GetCellDistance(*Updated, UpdatedNearest, ID) != GetCellDistance(*Built, BuiltNearest, ID) || (UpdatedNearest != INDEX_NONE && !Updated->IsNodeValid(UpdatedNearest)))
+                    {
+                        AddError(FString::Printf(TEXT("Grid %d edit %d: nearest valid node of cell (%d, %d) differs from a full build"), GridNumber, EditNumber, X, Y));
+                    }
+                }
+            }
+
+            // Clusters, their entrances and the costs between them
+            TestTrue(TEXT("Updated hierarchy covers the grid"), Updated->Hierarchy.IsBuiltFor(*Updated));
+            for (int32 X = 0; X < GridIndex.SizeX; X += FPathfindingHierarchy::ClusterSize)
+            {
+                for (int32 Y = 0; Y < GridIndex.SizeY; Y += FPathfindingHierarchy::ClusterSize)
+                {
+                    const int32 ClusterIndex = Built->Hierarchy.GetClusterIndex(FIntPoint(X, Y));
+                    const FPathfindingHierarchy::FCluster& UpdatedCluster = Updated->Hierarchy.GetCluster(ClusterIndex);
+                    const FPathfindingHierarchy::FCluster& BuiltCluster = Built->Hierarchy.GetCluster(ClusterIndex);
+                    bool bSameCluster = UpdatedCluster.Entrances.Num() == BuiltCluster.Entrances.Num() && UpdatedCluster.IntraCosts == BuiltCluster.IntraCosts;
+                    for (int32 EntranceIndex = 0; bSameCluster && EntranceIndex < BuiltCluster.Entrances.Num(); ++EntranceIndex)
+                    {
+                        bSameCluster = UpdatedCluster.Entrances[EntranceIndex].NodeIndex == BuiltCluster.Entrances[EntranceIndex].NodeIndex;
+                    }
+                    if (!bSameCluster)
+                    {
+                        AddError(FString::Printf(TEXT("Grid %d edit %d: cluster %d differs from a full build"), GridNumber, EditNumber, ClusterIndex));
+                    }
+                }
+            }
+
+            // Searches on the updated graph: landmarks stay a lower bound, the components match the paths and JPS stays exact
+            for (int32 QueryNumber = 0; QueryNumber < NumQueriesPerEdit; ++QueryNumber)
+            {
+                const int32 StartIndex = Random.RandHelper(Updated->Num());
+                const int32 EndIndex = Random.RandHelper(Updated->Num());
+                if (!Updated->IsNodeValid(StartIndex) || !Updated->IsNodeValid(EndIndex))
+                {
+                    continue;
+                }
+
+                const int32 ExactCost = GetPathCost(*Updated, PathfindingKernels::FindPath(*Updated, StartIndex, EndIndex, *Context, Path, ExactPolicies), Path);
+                const int32 JumpPointCost = GetPathCost(*Updated, PathfindingSearch::FindJumpPointPath(*Updated, StartIndex, EndIndex, *Context, Path), Path);
+                const int32 LandmarkBound = Updated->Landmarks ? Updated->Landmarks->GetHeuristic(StartIndex, EndIndex) : 0;
+                if (Updated->AreConnected(StartIndex, EndIndex) != (ExactCost != INDEX_NONE) || JumpPointCost != ExactCost || (ExactCost != INDEX_NONE && LandmarkBound > ExactCost))
+                {
+                    AddError(FString::Printf(TEXT("Grid %d edit %d: from node %d to %d A* costs %d, JPS %d, the landmark bound is %d and the nodes are%s connected"),
+                        GridNumber, EditNumber, StartIndex, EndIndex, ExactCost, JumpPointCost, LandmarkBound, Updated->AreConnected(StartIndex, EndIndex) ? TEXT("") : TEXT(" not")));
+                }
+            }
+
+            // D* Lite repaired across every edit so far must agree with a search started over on the full build
+            FPathfindingDStarLite FreshSearch;
+            FreshSearch.Initialize(Built, AgentStart, AgentGoal);
+            const int32 FreshCost = GetPathCost(*Built, FreshSearch.Replan(Path), Path);
+            const int32 RepairedCost = GetPathCost(*Updated, IncrementalSearch.Replan(Path), Path);
+            if (RepairedCost != FreshCost)
+            {
+                AddError(FString::Printf(TEXT("Grid %d edit %d: repaired D* Lite path costs %d, a fresh one %d"), GridNumber, EditNumber, RepairedCost, FreshCost));
+            }
+        }
+
+        Builder->Destroy();
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,126 @@
+/*
+    PathfindingSearchModesTest.cpp
+    Purpose: Automation test checking that the exact search modes find a path exactly where A* does, at the same cost, on random grids.
+*/
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Game/PathfindingGraph.h"
+#include "Game/PathfindingKernels.h"
+#include "Game/PathfindingSearch.h"
+#include "Game/PathfindingJumpPoints.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    // Graph over a GridSize grid with a node in every cell and a random BlockedFraction of them invalid. The same Seed gives the same graph
+    FPathfindingGraphPtr BuildRandomGraph(const FIntPoint& GridSize, float BlockedFraction, int32 Seed)
+    {
+        TSharedRef<FPathfindingGraph, ESPMode::ThreadSafe> Graph = MakeShared<FPathfindingGraph, ESPMode::ThreadSafe>();
+        FRandomStream Random(Seed);
+
+        // Nodes are added in the row-major order of the ID lookup, one per cell, spaced one unit apart
+        Graph->NodeIndexLookup.Initialize(GridSize.X, GridSize.Y);
+        for (int32 X = 0; X < GridSize.X; ++X)
+        {
+            for (int32 Y = 0; Y < GridSize.Y; ++Y)
+            {
+                const FIntPoint ID(X, Y);
+                Graph->NodeIndexLookup.Add(ID, Graph->AddNode(Graph->GridLayout.GridIDToLocal(ID), ID, Random.FRand() >= BlockedFraction));
+            }
+        }
+
+        // No component labels, so AreConnected lets every query run and walled-off pairs are left for the searches to fail
+        Graph->BuildSearchTables(8, 16 * 1024 * 1024);
+        return Graph;
+    }
+
+    // Jump Point Search returns straight and diagonal runs and the other modes single steps, which the octile distance costs exactly
+    int32 GetPathCost(const FPathfindingGraph& Graph, const TArray<int32>& NodeIndices)
+    {
+        int32 Cost = 0;
+        for (int32 PathIndex = 1; PathIndex < NodeIndices.Num(); ++PathIndex)
+        {
+            Cost += Graph.GetHeuristic(NodeIndices[PathIndex - 1], NodeIndices[PathIndex]);
+        }
+        return Cost;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPathfindingSearchModesTest, "WallClimber.Pathfinding.SearchModesMatchAStar",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+// Searches the same random queries with A* and every other exact search mode and fails on each query where they disagree on whether a path exists or on its cost
+bool FPathfindingSearchModesTest::RunTest(const FString& Parameters)
+{
+    constexpr int32 NumGrids = 16;
+    constexpr int32 NumQueriesPerGrid = 256;
+
+    typedef bool (*FSearchFunction)(const FPathfindingGraph&, int32, int32, FPathfindingSearchContext&, TArray<int32>&);
+    struct FComparedMode
+    {
+        const TCHAR* Name;
+        FSearchFunction Search;
+    };
+
+    // A* is the reference. These modes must find a path exactly where it does, at the same cost
+    const FComparedMode ComparedModes[] = {
+        { TEXT("Jump Point Search"), &PathfindingSearch::FindJumpPointPath },
+        { TEXT("Bidirectional A*"), &PathfindingSearch::FindBidirectionalAStarPath },
+    };
+
+    FRandomStream Random(0);
+    FScopedPathfindingSearchContext Context;
+    const FPathfindingSearchPolicies Policies;
+    TArray<int32> ValidNodes;
+    TArray<int32> ReferencePath;
+    TArray<int32> Path;
+
+    for (int32 GridNumber = 0; GridNumber < NumGrids; ++GridNumber)
+    {
+        // Sizes and densities from open ground to mazes cut into many pockets
+        const FIntPoint GridSize(Random.RandRange(8, 128), Random.RandRange(8, 128));
+        const float BlockedFraction = Random.FRandRange(0.f, 0.45f);
+        const FPathfindingGraphPtr Graph = BuildRandomGraph(GridSize, BlockedFraction, Random.RandHelper(MAX_int32));
+
+        ValidNodes.Reset();
+        for (int32 NodeIndex = 0; NodeIndex < Graph->Num(); ++NodeIndex)
+        {
+            if (Graph->IsNodeValid(NodeIndex))
+            {
+                ValidNodes.Add(NodeIndex);
+            }
+        }
+        if (ValidNodes.Num() == 0)
+        {
+            continue;
+        }
+
+        for (int32 QueryNumber = 0; QueryNumber < NumQueriesPerGrid; ++QueryNumber)
+        {
+            const int32 StartIndex = ValidNodes[Random.RandHelper(ValidNodes.Num())];
+            const int32 EndIndex = ValidNodes[Random.RandHelper(ValidNodes.Num())];
+            const bool bReferenceFound = PathfindingKernels::FindPath(*Graph, StartIndex, EndIndex, *Context, ReferencePath, Policies);
+            const int32 ReferenceCost = bReferenceFound ? GetPathCost(*Graph, ReferencePath) : -1;
+
+            for (const FComparedMode& Mode : ComparedModes)
+            {
+                const bool bFound = Mode.Search(*Graph, StartIndex, EndIndex, *Context, Path);
+                const int32 Cost = bFound ? GetPathCost(*Graph, Path) : -1;
+
+                if (bFound != bReferenceFound || Cost != ReferenceCost)
+                {
+                    const FIntPoint& StartID = Graph->NodeIDs[StartIndex];
+                    const FIntPoint& EndID = Graph->NodeIDs[EndIndex];
+                    AddError(FString::Printf(TEXT("%s on grid %d (%dx%d, %.0f%% blocked) from (%d, %d) to (%d, %d) costs %d, A* %d"),
+                        Mode.Name, GridNumber, GridSize.X, GridSize.Y, BlockedFraction * 100.f, StartID.X, StartID.Y, EndID.X, EndID.Y, Cost, ReferenceCost));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS